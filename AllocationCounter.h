@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// With GACHA_COUNT_ALLOCATIONS, AllocationGuard aborts if its scope reached
+// operator new on this thread. The one translation unit that defines
+// GACHA_ALLOCATION_HOOKS_IMPLEMENTATION first gets the counting operators.
+
+inline size_t& allocationCount() {
+    static thread_local size_t count = 0;
+    return count;
+}
+
+class AllocationGuard {
+public:
+    explicit AllocationGuard(const char* scope) : scope(scope), start(allocationCount()) {}
+
+    ~AllocationGuard() {
+        const size_t allocations = allocationCount() - start;
+        if (allocations != 0) {
+            std::fprintf(stderr, "%s performed %zu heap allocation(s)\n", scope, allocations);
+            std::abort();
+        }
+    }
+
+private:
+    const char* scope;
+    size_t start;
+};
+
+#if defined(GACHA_COUNT_ALLOCATIONS) && defined(GACHA_ALLOCATION_HOOKS_IMPLEMENTATION)
+// Kept out of line so GCC does not pair the inlined malloc/free and warn.
+#if defined(__GNUC__)
+#define GACHA_NOINLINE __attribute__((noinline))
+#else
+#define GACHA_NOINLINE
+#endif
+
+GACHA_NOINLINE void* operator new(size_t size) {
+    allocationCount()++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+GACHA_NOINLINE void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocationCount()++;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+GACHA_NOINLINE void operator delete(void* p) noexcept { std::free(p); }
+GACHA_NOINLINE void operator delete[](void* p) noexcept { std::free(p); }
+GACHA_NOINLINE void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+GACHA_NOINLINE void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,186 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Arena for player and inventory storage: power-of-two size classes carved
+// from large blocks, with a free list per class. Chunks are MinClassBytes
+// aligned. Not thread-safe; destroy its containers before reset().
+class Arena {
+public:
+    static const size_t DefaultBlockBytes = 1 << 20;
+    static const size_t MinClassBytes = 16;
+    static const size_t MaxClassBytes = 64 * 1024;
+
+    explicit Arena(size_t blockBytes = DefaultBlockBytes)
+        : blockBytes(blockBytes < MaxClassBytes ? MaxClassBytes : blockBytes),
+          currentBlock(0), cursor(0), end(0), bytesUsed(0), peakBytesUsed(0), largeBytes(0) {
+        for (int c = 0; c < ClassCount; ++c) freeLists[c] = 0;
+    }
+
+    ~Arena() { release(); }
+
+    void* allocate(size_t bytes) {
+        if (bytes > MaxClassBytes) return allocateLarge(bytes);
+        const int c = sizeClass(bytes);
+        const size_t size = MinClassBytes << c;
+        track(size);
+        if (FreeChunk* chunk = freeLists[c]) {
+            freeLists[c] = chunk->next;
+            return chunk;
+        }
+        if (cursor == 0 || size > static_cast<size_t>(end - cursor)) nextBlock();
+        void* p = cursor;
+        cursor += size;
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes) {
+        if (!p) return;
+        if (bytes > MaxClassBytes) {
+            freeLarge(p, bytes);
+            return;
+        }
+        const int c = sizeClass(bytes);
+        bytesUsed -= MinClassBytes << c;
+        FreeChunk* chunk = static_cast<FreeChunk*>(p);
+        chunk->next = freeLists[c];
+        freeLists[c] = chunk;
+    }
+
+    // Forgets every allocation; blocks are kept for reuse.
+    void reset() {
+        for (int c = 0; c < ClassCount; ++c) freeLists[c] = 0;
+        for (size_t i = 0; i < large.size(); ++i) ::operator delete(large[i].data);
+        large.clear();
+        largeBytes = 0;
+        currentBlock = 0;
+        cursor = blocks.empty() ? 0 : blocks[0];
+        end = blocks.empty() ? 0 : blocks[0] + blockBytes;
+        bytesUsed = 0;
+    }
+
+    // Forgets every allocation and returns all memory to the system.
+    void release() {
+        reset();
+        for (size_t i = 0; i < blocks.size(); ++i) ::operator delete(blocks[i]);
+        blocks.clear();
+        cursor = end = 0;
+    }
+
+    // Bytes obtained from the system: blocks plus live large allocations.
+    size_t getBytesReserved() const { return blocks.size() * blockBytes + largeBytes; }
+    // Bytes handed out and not yet freed, rounded up to size classes.
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getPeakBytesUsed() const { return peakBytesUsed; }
+
+private:
+    struct FreeChunk {
+        FreeChunk* next;
+    };
+
+    struct LargeAllocation {
+        void* data;
+        size_t bytes;
+    };
+
+    static const int ClassCount = 13;   // 16 << 12 == MaxClassBytes
+    static_assert((MinClassBytes << (ClassCount - 1)) == MaxClassBytes, "size classes must end at MaxClassBytes");
+
+    size_t blockBytes;
+    std::vector<char*> blocks;
+    size_t currentBlock;
+    char* cursor;
+    char* end;
+    FreeChunk* freeLists[ClassCount];
+    std::vector<LargeAllocation> large;
+    size_t bytesUsed;
+    size_t peakBytesUsed;
+    size_t largeBytes;
+
+    static int sizeClass(size_t bytes) {
+        int c = 0;
+        while ((MinClassBytes << c) < bytes) ++c;
+        return c;
+    }
+
+    void track(size_t bytes) {
+        bytesUsed += bytes;
+        if (bytesUsed > peakBytesUsed) peakBytesUsed = bytesUsed;
+    }
+
+    // Moves to the next kept block, or adds one; the rest of the old block is
+    // abandoned until reset.
+    void nextBlock() {
+        if (cursor != 0) ++currentBlock;
+        if (currentBlock == blocks.size()) blocks.push_back(static_cast<char*>(::operator new(blockBytes)));
+        cursor = blocks[currentBlock];
+        end = cursor + blockBytes;
+    }
+
+    void* allocateLarge(size_t bytes) {
+        LargeAllocation allocation = { ::operator new(bytes), bytes };
+        large.push_back(allocation);
+        largeBytes += bytes;
+        track(bytes);
+        return allocation.data;
+    }
+
+    void freeLarge(void* p, size_t bytes) {
+        for (size_t i = large.size(); i-- > 0; ) {
+            if (large[i].data != p) continue;
+            ::operator delete(p);
+            large[i] = large.back();
+            large.pop_back();
+            largeBytes -= bytes;
+            bytesUsed -= bytes;
+            return;
+        }
+    }
+
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+};
+
+// Standard allocator over an Arena; with no arena it uses the global heap, so
+// containers default to ordinary behaviour. The arena travels with container
+// copies, moves and swaps.
+template <class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator(Arena* arena = 0) : arena(arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.getArena()) {}
+
+    T* allocate(size_t n) {
+        static_assert(alignof(T) <= Arena::MinClassBytes, "arena chunks are only MinClassBytes aligned");
+        const size_t bytes = n * sizeof(T);
+        return static_cast<T*>(arena ? arena->allocate(bytes) : ::operator new(bytes));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (arena) arena->deallocate(p, n * sizeof(T));
+        else ::operator delete(p);
+    }
+
+    Arena* getArena() const { return arena; }
+
+private:
+    Arena* arena;
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.getArena() == b.getArena(); }
+
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.getArena() != b.getArena(); }
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
@@ -0,0 +1,158 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time banners: names, rarities and tier weights in parts-per-billion,
+// with the per-item weights, ids and name order computed by the compiler.
+
+struct BannerItem {
+    const char* name;
+    int rarity;
+};
+
+struct BannerTier {
+    int rarity;
+    uint64_t weight;             // whole tier, split evenly across its items
+    uint64_t pityBonusPerItem;   // added to each of the tier's items while pity is active
+};
+
+struct Banner {
+    const BannerItem* items;     // sorted by rarity
+    const uint64_t* itemWeights;
+    const uint32_t* itemIds;     // 0..itemCount-1, the ids a bound ItemCatalog gives the items
+    const uint32_t* nameOrder;   // item indices sorted by name (strcmp order)
+    size_t itemCount;
+    const BannerTier* tiers;
+    size_t tierCount;
+};
+
+template <class T, size_t N>
+constexpr size_t bannerCountOf(const T (&)[N]) { return N; }
+
+constexpr size_t bannerTierSize(const BannerItem* items, size_t n, int rarity) {
+    return n == 0 ? 0 : (items[n - 1].rarity == rarity ? 1 : 0) + bannerTierSize(items, n - 1, rarity);
+}
+
+constexpr uint64_t bannerTierWeight(const BannerTier* tiers, size_t n, int rarity) {
+    return n == 0 ? 0 : tiers[n - 1].rarity == rarity ? tiers[n - 1].weight : bannerTierWeight(tiers, n - 1, rarity);
+}
+
+constexpr bool bannerHasTier(const BannerTier* tiers, size_t n, int rarity) {
+    return n != 0 && (tiers[n - 1].rarity == rarity || bannerHasTier(tiers, n - 1, rarity));
+}
+
+constexpr bool bannerIsValid(const BannerItem* items, size_t n, const BannerTier* tiers, size_t tierCount) {
+    return n == 0 ||
+        ((n < 2 || items[n - 2].rarity <= items[n - 1].rarity) &&
+         bannerHasTier(tiers, tierCount, items[n - 1].rarity) &&
+         bannerIsValid(items, n - 1, tiers, tierCount));
+}
+
+constexpr int bannerCompareNames(const char* a, const char* b) {
+    return *a == 0 || *a != *b
+        ? static_cast<int>(static_cast<unsigned char>(*a)) - static_cast<int>(static_cast<unsigned char>(*b))
+        : bannerCompareNames(a + 1, b + 1);
+}
+
+// Position of item i in name order; equal names keep their item order.
+constexpr size_t bannerNameRank(const BannerItem* items, size_t n, size_t i) {
+    return n == 0 ? 0 :
+        (bannerCompareNames(items[n - 1].name, items[i].name) < 0 ||
+         (n - 1 < i && bannerCompareNames(items[n - 1].name, items[i].name) == 0) ? 1 : 0) +
+        bannerNameRank(items, n - 1, i);
+}
+
+constexpr size_t bannerItemAtRank(const BannerItem* items, size_t n, size_t rank, size_t i) {
+    return i + 1 >= n || bannerNameRank(items, n, i) == rank ? i : bannerItemAtRank(items, n, rank, i + 1);
+}
+
+// Tier weight divided evenly (rounded to nearest) across the tier's items.
+constexpr uint64_t bannerItemWeight(const BannerItem* items, size_t n, const BannerTier* tiers, size_t tierCount,
+                                    size_t i) {
+    return (bannerTierWeight(tiers, tierCount, items[i].rarity) + bannerTierSize(items, n, items[i].rarity) / 2) /
+           bannerTierSize(items, n, items[i].rarity);
+}
+
+template <size_t... I>
+struct BannerIndexList {};
+
+template <size_t N, size_t... I>
+struct MakeBannerIndexList : MakeBannerIndexList<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeBannerIndexList<0, I...> { typedef BannerIndexList<I...> type; };
+
+template <size_t N>
+struct BannerWeightTable {
+    uint64_t values[N];
+};
+
+template <size_t N>
+struct BannerIdTable {
+    uint32_t values[N];
+};
+
+template <size_t N, size_t... I>
+constexpr BannerIdTable<N> makeBannerIds(BannerIndexList<I...>) {
+    return BannerIdTable<N>{{ static_cast<uint32_t>(I)... }};
+}
+
+template <size_t N, size_t... I>
+constexpr BannerIdTable<N> makeBannerNameOrder(const BannerItem (&items)[N], BannerIndexList<I...>) {
+    return BannerIdTable<N>{{ static_cast<uint32_t>(bannerItemAtRank(items, N, I, 0))... }};
+}
+
+template <size_t N, size_t TierCount, size_t... I>
+constexpr BannerWeightTable<N> makeBannerWeights(const BannerItem (&items)[N], const BannerTier (&tiers)[TierCount],
+                                                 BannerIndexList<I...>) {
+    return BannerWeightTable<N>{{ bannerItemWeight(items, N, tiers, TierCount, I)... }};
+}
+
+template <size_t N, size_t TierCount>
+constexpr BannerWeightTable<N> makeBannerWeights(const BannerItem (&items)[N], const BannerTier (&tiers)[TierCount]) {
+    return makeBannerWeights(items, tiers, typename MakeBannerIndexList<N>::type());
+}
+
+// Standard banner
+constexpr BannerItem DefaultBannerItems[] = {
+    { "Common Sword", 1 }, { "Rusty Dagger", 1 }, { "Wooden Ladle", 1 }, { "Tree Branch", 1 },
+    { "Small Rock", 1 }, { "Wooden Club", 1 }, { "Common Spear", 1 },
+
+    { "Torch", 2 }, { "Kitchen Knife", 2 }, { "Skeleton Arm", 2 }, { "Reinforced Sword", 2 },
+    { "Reinforced Spear", 2 },
+
+    { "Rare Spear", 3 }, { "Fire Sword", 3 }, { "Ice Sword", 3 }, { "Rare Claymore", 3 },
+
+    { "Epic Staff", 4 }, { "Fire Claymore", 4 }, { "Ice Claymore", 4 },
+
+    { "Legendary Blade", 5 }, { "Sword of Sparda", 5 },
+
+    { "Master Sword", 6 }
+};
+
+constexpr BannerTier DefaultBannerTiers[] = {
+    { 1, 80000000000ULL, 0 },
+    { 2, 25000000000ULL, 0 },
+    { 3, 15000000000ULL, 0 },
+    { 4, 7000000000ULL, 50000000000ULL },
+    { 5, 1900000000ULL, 20000000000ULL },
+    { 6, 10000000ULL, 10000000000ULL }
+};
+
+static_assert(bannerIsValid(DefaultBannerItems, bannerCountOf(DefaultBannerItems),
+                            DefaultBannerTiers, bannerCountOf(DefaultBannerTiers)),
+              "default banner items must be sorted by rarity and have a tier");
+
+constexpr BannerWeightTable<bannerCountOf(DefaultBannerItems)> DefaultBannerWeights =
+    makeBannerWeights(DefaultBannerItems, DefaultBannerTiers);
+
+constexpr BannerIdTable<bannerCountOf(DefaultBannerItems)> DefaultBannerIds =
+    makeBannerIds<bannerCountOf(DefaultBannerItems)>(MakeBannerIndexList<bannerCountOf(DefaultBannerItems)>::type());
+
+constexpr BannerIdTable<bannerCountOf(DefaultBannerItems)> DefaultBannerNameOrder =
+    makeBannerNameOrder(DefaultBannerItems, MakeBannerIndexList<bannerCountOf(DefaultBannerItems)>::type());
+
+constexpr Banner DefaultBanner = {
+    DefaultBannerItems, DefaultBannerWeights.values, DefaultBannerIds.values, DefaultBannerNameOrder.values,
+    bannerCountOf(DefaultBannerItems), DefaultBannerTiers, bannerCountOf(DefaultBannerTiers)
+};
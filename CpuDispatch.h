@@ -0,0 +1,36 @@
+#pragma once
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define GACHA_X86_DISPATCH 1
+#endif
+
+// Kernels come in scalar, AVX2 and AVX-512 versions; the vector versions only
+// exist when GACHA_X86_DISPATCH is defined.
+enum class KernelLevel { Scalar, Avx2, Avx512 };
+
+// The widest level the running CPU supports, detected once per process.
+inline KernelLevel cpuKernelLevel() {
+#ifdef GACHA_X86_DISPATCH
+    static const KernelLevel level =
+        __builtin_cpu_supports("avx512f") ? KernelLevel::Avx512 :
+        __builtin_cpu_supports("avx2") ? KernelLevel::Avx2 :
+        KernelLevel::Scalar;
+    return level;
+#else
+    return KernelLevel::Scalar;
+#endif
+}
+
+template <class Fn>
+inline Fn kernelForLevel(KernelLevel level, Fn scalar, Fn avx2, Fn avx512) {
+    return level == KernelLevel::Avx512 ? avx512 : level == KernelLevel::Avx2 ? avx2 : scalar;
+}
+
+// The version of a kernel for cpuKernelLevel(); without GACHA_X86_DISPATCH the
+// vector names are never referenced.
+#ifdef GACHA_X86_DISPATCH
+#define GACHA_WIDEST_KERNEL(scalar, avx2, avx512) kernelForLevel(cpuKernelLevel(), scalar, avx2, avx512)
+#else
+#define GACHA_WIDEST_KERNEL(scalar, avx2, avx512) (scalar)
+#endif
@@ -0,0 +1,252 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "ItemCatalog.h"
+
+// Structured game events, posted into a lock-free ring and written to a
+// backend (console, binary file or nothing) by a background thread.
+
+enum class GameEventType : uint8_t {
+    Pulled,              // item
+    Sold,                // item, count copies, value currency
+    Salvaged,            // count copies, value currency
+    PityOn,
+    PityOff,
+    InsufficientFunds,
+    InventoryFull,
+    PartialBatch,        // count of value requested pulls happened
+    InvalidSelection,
+    PoolEmpty
+};
+
+struct GameEvent {
+    GameEventType type;
+    uint64_t player;
+    ItemId item;
+    uint32_t count;
+    int32_t value;
+};
+
+inline GameEvent makeEvent(GameEventType type, uint64_t player, ItemId item = InvalidItem,
+                           uint32_t count = 0, int32_t value = 0) {
+    GameEvent event = { type, player, item, count, value };
+    return event;
+}
+
+// Receives drained events on the sink's thread, in posting order.
+class EventBackend {
+public:
+    virtual ~EventBackend() {}
+    virtual void write(const GameEvent* events, size_t n) = 0;
+    virtual void flush() {}
+};
+
+class NullEventBackend : public EventBackend {
+public:
+    void write(const GameEvent*, size_t) {}
+};
+
+// The game's console messages, written by the drain thread.
+class ConsoleEventBackend : public EventBackend {
+public:
+    explicit ConsoleEventBackend(const ItemCatalog& catalog) : catalog(&catalog) {}
+
+    void write(const GameEvent* events, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            const GameEvent& e = events[i];
+            switch (e.type) {
+                case GameEventType::Pulled:
+                    std::cout << "\nObtained: " << catalog->getName(e.item)
+                              << " [" << catalog->getRarity(e.item) << "*]\n";
+                    break;
+                case GameEventType::Sold:
+                    std::cout << "Sold: " << catalog->getName(e.item);
+                    if (e.count > 1) std::cout << " x" << e.count;
+                    std::cout << " for " << e.value << " currency.\n";
+                    break;
+                case GameEventType::Salvaged:
+                    std::cout << "Salvaged " << e.count << " items for " << e.value << " currency.\n";
+                    break;
+                case GameEventType::PityOn:
+                    std::cout << "\nPity system activated, odds increased!\n";
+                    break;
+                case GameEventType::PityOff:
+                    std::cout << "\nPity system deactivated!\n";
+                    break;
+                case GameEventType::InsufficientFunds:
+                    std::cout << "You cannot afford anymore. ☹️\n";
+                    break;
+                case GameEventType::InventoryFull:
+                    std::cout << "Please sell to make space!\n";
+                    break;
+                case GameEventType::PartialBatch:
+                    std::cout << "Only " << e.count << " of " << e.value << " pulls were possible.\n";
+                    break;
+                case GameEventType::InvalidSelection:
+                    std::cout << "Invalid item selection!\n";
+                    break;
+                case GameEventType::PoolEmpty:
+                    std::cout << "There is nothing to pull.\n";
+                    break;
+            }
+        }
+    }
+
+    void flush() { std::cout << std::flush; }
+
+private:
+    const ItemCatalog* catalog;
+};
+
+// Packed RecordBytes-byte records for offline analysis: type, player, item,
+// count, value, each in host byte order with no padding, so equal events
+// always give equal bytes.
+class BinaryFileEventBackend : public EventBackend {
+public:
+    static const size_t RecordBytes = sizeof(uint8_t) + sizeof(uint64_t) + sizeof(ItemId) + sizeof(uint32_t) +
+                                      sizeof(int32_t);
+
+    explicit BinaryFileEventBackend(const std::string& path) : file(std::fopen(path.c_str(), "wb")) {}
+    ~BinaryFileEventBackend() { if (file) std::fclose(file); }
+
+    bool isOpen() const { return file != 0; }
+
+    void write(const GameEvent* events, size_t n) {
+        if (!file) return;
+        unsigned char record[RecordBytes];
+        for (size_t i = 0; i < n; ++i) {
+            const GameEvent& e = events[i];
+            const uint8_t type = static_cast<uint8_t>(e.type);
+            unsigned char* out = record;
+            std::memcpy(out, &type, sizeof(type));
+            std::memcpy(out += sizeof(type), &e.player, sizeof(e.player));
+            std::memcpy(out += sizeof(e.player), &e.item, sizeof(e.item));
+            std::memcpy(out += sizeof(e.item), &e.count, sizeof(e.count));
+            std::memcpy(out += sizeof(e.count), &e.value, sizeof(e.value));
+            std::fwrite(record, RecordBytes, 1, file);
+        }
+    }
+
+    void flush() { if (file) std::fflush(file); }
+
+private:
+    std::FILE* file;
+    BinaryFileEventBackend(const BinaryFileEventBackend&);
+    BinaryFileEventBackend& operator=(const BinaryFileEventBackend&);
+};
+
+// Bounded multi-producer ring (per-cell sequence numbers) with one consumer
+// thread. post never allocates. When the ring is full it waits for the drain
+// thread, or with dropWhenFull drops and counts the event instead.
+class EventSink {
+public:
+    static const size_t DefaultCapacity = 4096;
+
+    // capacity must be a power of two: positions map to cells through mask.
+    explicit EventSink(std::unique_ptr<EventBackend> backend, size_t capacity = DefaultCapacity,
+                       bool dropWhenFull = false)
+        : backend(std::move(backend)), cells(new Cell[capacity]), mask(capacity - 1), dropWhenFull(dropWhenFull),
+          enqueuePos(0), dequeuePos(0), drained(0), dropped(0), stopping(false) {
+        assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+        for (size_t i = 0; i < capacity; ++i) cells[i].sequence.store(i, std::memory_order_relaxed);
+        worker = std::thread(&EventSink::drainLoop, this);
+    }
+
+    ~EventSink() {
+        stopping.store(true, std::memory_order_release);
+        worker.join();
+    }
+
+    bool post(const GameEvent& event) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.event = event;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                if (dropWhenFull) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                std::this_thread::yield();
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Waits until everything posted so far has reached the backend and been
+    // flushed. Interactive prompts call this before writing to the console.
+    void flush() const {
+        const size_t target = enqueuePos.load(std::memory_order_acquire);
+        while (drained.load(std::memory_order_acquire) < target) std::this_thread::yield();
+    }
+
+    size_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        GameEvent event;
+    };
+
+    static const size_t DrainBatch = 64;
+
+    std::unique_ptr<EventBackend> backend;
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    bool dropWhenFull;
+    alignas(64) std::atomic<size_t> enqueuePos;
+    alignas(64) size_t dequeuePos;     // drain thread only
+    std::atomic<size_t> drained;
+    std::atomic<size_t> dropped;
+    std::atomic<bool> stopping;
+    std::thread worker;
+
+    size_t drainOnce() {
+        GameEvent batch[DrainBatch];
+        size_t n = 0;
+        while (n < DrainBatch) {
+            Cell& cell = cells[dequeuePos & mask];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeuePos + 1) break;
+            batch[n++] = cell.event;
+            cell.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+            ++dequeuePos;
+        }
+        if (n != 0) {
+            backend->write(batch, n);
+            backend->flush();   // before publishing progress to flush()
+            drained.fetch_add(n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    void drainLoop() {
+        for (;;) {
+            if (drainOnce() != 0) continue;
+            if (stopping.load(std::memory_order_acquire)) {
+                while (drainOnce() != 0) {}
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    EventSink(const EventSink&);
+    EventSink& operator=(const EventSink&);
+};
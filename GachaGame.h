@@ -1,114 +1,662 @@
 #pragma once
+#include <cassert>
 #include <iostream>
 #include <vector>
 #include <string>
-#include <memory>
 #include <random>
 #include <map>
+#include "Random.h"
+#include "SearchKernels.h"
+#include "Banner.h"
+#include "ItemCatalog.h"
+#include "Inventory.h"
+#include "AllocationCounter.h"
+#include "EventSink.h"
+
+// Selects how an item is picked once its rarity tier has been drawn.
+enum class SamplingMode {
+    Linear,   // cumulative scan over the tier's rates, O(tier size) per pull
+    Alias,    // Walker/Vose alias table per tier, O(1) per pull, rebuilt lazily after rate edits
+    Fenwick,  // binary indexed tree per tier, O(log n) per pull and per single-item rate edit
+    PrefixSum // aligned prefix-sum table per tier, searched with SIMD kernels (SearchKernels.h)
+};
 
-class GachaItem final {
+// Draws a rarity tier, then an item from that tier's slice of items/rates.
+// Rates are stored as integer parts-per-billion, so edits never drift.
+class GachaPool {
 public:
-    GachaItem(const std::string& name, int rarity) : name(name), rarity(rarity) {}
-    ~GachaItem() = default;
+    typedef Xoshiro256StarStar RandomEngine;
+    typedef uint64_t Weight;
 
-    std::string getName() const { return name; }
-    int getRarity() const { return rarity; }
+    static const Weight WeightScale = 1000000000;   // 1.0 rate == 1e9 ppb
+    static const size_t MaxTiers = MaxRarity;       // one per rarity
+    static const size_t MaxRateStates = 8;
+    static const size_t npos = static_cast<size_t>(-1);
 
-private:
-    std::string name;
-    int rarity;
-};
+    static Weight toWeight(double rate) {
+        return rate <= 0.0 ? 0 : static_cast<Weight>(rate * WeightScale + 0.5);
+    }
 
-class GachaPool {
-public:
-    GachaPool() {
-        std::random_device rd;
-        generator.seed(rd());
-        totalRate = 0.0;
+    GachaPool()
+        : borrowed(0), tiers(), tierCount(0), totalWeight(0), generator(nondeterministicSeed()),
+          samplingMode(SamplingMode::Linear), prefixDirty(true), states(), stateCount(1), currentState(0),
+          stateTablesDirty(true), tablesStale(true) {}
+
+    // Returns the item's index, or npos if its rarity would need a tier past MaxTiers.
+    size_t addItem(ItemId item, int rarity, double rate) {
+        size_t t = findTier(rarity);
+        if (t == npos) {
+            if (tierCount == MaxTiers) return npos;
+            t = insertTier(rarity);
+        }
+
+        ownTables();
+        const Weight weight = toWeight(rate);
+        size_t index = tiers[t].first + tiers[t].count;
+        items.insert(items.begin() + index, item);
+        rates.insert(rates.begin() + index, weight);
+        tiers[t].count++;
+        tiers[t].itemTotal += weight;
+        for (size_t i = t + 1; i < tierCount; ++i) tiers[i].first++;
+        for (size_t i = 0; i < tierCount; ++i) {
+            tiers[i].aliasDirty = true;
+            tiers[i].fenwickDirty = true;
+        }
+        prefixDirty = true;
+        totalWeight += weight;
+        stateTablesDirty = true;
+        tablesStale = true;
+        return index;
     }
 
-    void addItem(const std::shared_ptr<GachaItem>& item, double rate) {
-        items.push_back(item);
-        rates.push_back(rate);
-        totalRate += rate;
+    // Rate state with a per-rarity bonus on top of the items' rates, or npos
+    // once MaxRateStates are in use.
+    size_t addRateState(const std::map<int, double>& tierBonus) {
+        RateState state = RateState();
+        for (std::map<int, double>::const_iterator it = tierBonus.begin(); it != tierBonus.end(); ++it) {
+            size_t t = findTier(it->first);
+            if (t != npos) state.bonus[t] = toWeight(it->second);
+        }
+        return pushState(state);
     }
 
-    std::shared_ptr<GachaItem> pull() {
-        std::uniform_real_distribution<double> distribution(0.0, totalRate);
-        double randomValue = distribution(generator);
-        double cumulative = 0.0;
+    // Loads a banner into an empty pool and returns its pity rate state. The
+    // banner's tables are read in place when catalog is bound to it. Returns
+    // npos and loads nothing if it has more than MaxTiers rarities.
+    size_t loadBanner(const Banner& banner, ItemCatalog& catalog) {
+        size_t rarities = 0;
+        for (size_t i = 0; i < banner.itemCount; ++i) {
+            rarities += i == 0 || banner.items[i].rarity != banner.items[i - 1].rarity;
+        }
+        if (rarities > MaxTiers || stateCount == MaxRateStates) return npos;
+
+        if (catalog.isBoundTo(banner)) {
+            borrowed = &banner;
+        } else {
+            items.reserve(banner.itemCount);
+            rates.reserve(banner.itemCount);
+            for (size_t i = 0; i < banner.itemCount; ++i) {
+                items.push_back(catalog.intern(banner.items[i].name, banner.items[i].rarity));
+                rates.push_back(banner.itemWeights[i]);
+            }
+        }
+        for (size_t i = 0; i < banner.itemCount; ++i) {
+            const int rarity = banner.items[i].rarity;
+            if (tierCount == 0 || tiers[tierCount - 1].rarity != rarity) tiers[insertTier(rarity)].first = i;
+            RarityTier& tier = tiers[tierCount - 1];
+            tier.count++;
+            tier.itemTotal += banner.itemWeights[i];
+            totalWeight += banner.itemWeights[i];
+        }
 
-        for (size_t i = 0; i < items.size(); ++i) {
-            cumulative += rates[i];
-            if (randomValue <= cumulative) return items[i];
+        RateState pity = RateState();
+        for (size_t i = 0; i < banner.tierCount; ++i) {
+            size_t t = findTier(banner.tiers[i].rarity);
+            if (t != npos) pity.bonus[t] = banner.tiers[i].pityBonusPerItem * tiers[t].count;
         }
-        return nullptr;
+        prefixDirty = true;
+        return pushState(pity);
     }
 
-    std::vector<std::shared_ptr<GachaItem>> getItems() { return items; }
+    void setRateState(size_t state) { currentState = state; }
+    size_t getRateState() const { return currentState; }
+    size_t getRateStateCount() const { return stateCount; }
+
+    ItemId pull() { return pull(generator, currentState); }
+
+    template <class Engine>
+    ItemId pull(Engine& rng) { return pull(rng, currentState); }
+
+    template <class Engine>
+    ItemId pull(Engine& rng, size_t state) {
+        if (empty()) return InvalidItem;
+        return itemData()[pullIndex(rng, state)];
+    }
+
+    // Index of the drawn item (see getItem); the pool must not be empty.
+    template <class Engine>
+    size_t pullIndex(Engine& rng, size_t state) {
+        if (tablesStale) prepare();
+        return drawIndex(rng, state);
+    }
+
+    // Pull pullNumber of player, derived from Philox4x32 block pullNumber << 32.
+    size_t derivePullIndex(uint64_t bannerSeed, uint64_t player, uint32_t pullNumber, size_t state) const {
+        Philox4x32 rng(bannerSeed, player);
+        rng.seek(static_cast<uint64_t>(pullNumber) << 32);
+        return drawIndex(rng, state);
+    }
+
+    // Reads the prepared tables only.
+    template <class Engine>
+    size_t drawIndex(Engine& rng, size_t state) const {
+        assert(!tablesStale && "call prepare() after editing the pool");
+        const RarityTier& tier = tiers[pullTier(rng, states[state])];
+        if (tier.itemTotal == 0) return tier.first + uniformBelow(rng, tier.count);
+        if (samplingMode == SamplingMode::Alias) return pullAlias(tier, rng);
+        if (samplingMode == SamplingMode::Fenwick) return pullFenwick(tier, rng);
+        if (samplingMode == SamplingMode::PrefixSum) return pullPrefix(tier, rng);
+
+        const Weight randomValue = uniformBelow(rng, tier.itemTotal);
+        const Weight* weights = rateData();
+        Weight cumulative = 0;
+
+        const size_t last = tier.first + tier.count - 1;
+        for (size_t i = tier.first; i < last; ++i) {
+            cumulative += weights[i];
+            if (randomValue < cumulative) return i;
+        }
+        return last;
+    }
+
+    // Appends n draws to out, generating the random words a block at a time.
+    void pullBatch(size_t n, std::vector<ItemId>& out) {
+        pullBatch(n, out, generator, currentState);
+    }
+
+    template <class Engine>
+    void pullBatch(size_t n, std::vector<ItemId>& out, Engine& rng, size_t state) {
+        if (empty() || n == 0) return;
+        prepare();
+        RandomBlock<Engine> block(rng);
+        const ItemId* ids = itemData();
+        out.reserve(out.size() + n);
+        for (size_t i = 0; i < n; ++i) out.push_back(ids[drawIndex(block, state)]);
+    }
+
+    void seed(uint64_t value) { generator.seed(value); }
+
+    // Builds the lazy tables; the pool is then safe to share read-only.
+    void prepare() {
+        if (stateTablesDirty) rebuildStateTables();
+        for (size_t t = 0; t < tierCount; ++t) {
+            if (samplingMode == SamplingMode::Alias && tiers[t].aliasDirty) rebuildAliasTable(tiers[t]);
+            if (samplingMode == SamplingMode::Fenwick && tiers[t].fenwickDirty) rebuildFenwick(tiers[t]);
+        }
+        if (samplingMode == SamplingMode::PrefixSum && prefixDirty) rebuildPrefix();
+        tablesStale = false;
+    }
+
+    bool isPrepared() const { return !tablesStale; }
+
+    size_t getItemCount() const { return borrowed ? borrowed->itemCount : items.size(); }
+    bool empty() const { return getItemCount() == 0; }
+    ItemId getItem(size_t index) const { return itemData()[index]; }
+    RandomEngine& getEngine() { return generator; }
+
+    void setSamplingMode(SamplingMode mode) {
+        samplingMode = mode;
+        tablesStale = true;
+    }
+    SamplingMode getSamplingMode() const { return samplingMode; }
+
+    Weight getWeight(size_t index) const { return rateData()[index]; }
+    Weight getTotalWeight() const { return totalWeight + bonusTotal(states[currentState]); }
 
     void increaseRate(size_t index, double increaseBy) {
-        rates[index] += increaseBy;
-        totalRate += increaseBy;
+        ownTables();
+        RarityTier& tier = tiers[tierOf(index)];
+        const Weight delta = toWeight(increaseBy);
+        rates[index] += delta;
+        tier.itemTotal += delta;
+        tier.aliasDirty = true;
+        if (!tier.fenwickDirty) fenwickAdd(tier, index - tier.first, delta);
+        prefixDirty = true;
+        totalWeight += delta;
+        stateTablesDirty = true;
+        tablesStale = true;
     }
 
+    // Rates never go below zero; a larger decrease removes what is left.
     void decreaseRate(size_t index, double decreaseBy) {
-        rates[index] -= decreaseBy;
-        totalRate -= decreaseBy;
+        ownTables();
+        RarityTier& tier = tiers[tierOf(index)];
+        Weight delta = toWeight(decreaseBy);
+        if (delta > rates[index]) delta = rates[index];
+        rates[index] -= delta;
+        tier.itemTotal -= delta;
+        tier.aliasDirty = true;
+        // Unsigned wrap-around makes adding 0 - delta a subtraction.
+        if (!tier.fenwickDirty) fenwickAdd(tier, index - tier.first, 0 - delta);
+        prefixDirty = true;
+        totalWeight -= delta;
+        stateTablesDirty = true;
+        tablesStale = true;
+    }
+
+    // Tier edits apply to the current rate state and leave the items alone.
+    void increaseTierRate(int rarity, double increaseBy) {
+        size_t t = findTier(rarity);
+        if (t == npos) return;
+        states[currentState].bonus[t] += toWeight(increaseBy);
+        stateTablesDirty = true;
+        tablesStale = true;
+    }
+
+    void decreaseTierRate(int rarity, double decreaseBy) {
+        size_t t = findTier(rarity);
+        if (t == npos) return;
+        Weight& bonus = states[currentState].bonus[t];
+        Weight delta = toWeight(decreaseBy);
+        bonus -= delta > bonus ? bonus : delta;
+        stateTablesDirty = true;
+        tablesStale = true;
+    }
+
+    size_t getTierSize(int rarity) const {
+        size_t t = findTier(rarity);
+        return t == npos ? 0 : tiers[t].count;
+    }
+
+    // Tier-level odds; tiers are sorted by rarity.
+    size_t getTierCount() const { return tierCount; }
+    int getTierRarity(size_t t) const { return tiers[t].rarity; }
+    Weight getTierWeight(size_t t, size_t state) const { return tiers[t].itemTotal + states[state].bonus[t]; }
+    Weight getStateTotalWeight(size_t state) const { return stateTotal(states[state]); }
+
+    // Tier for a uniform u in [0, 1), monotone in u.
+    size_t tierAt(double u, size_t state) const {
+        const RateState& table = states[state];
+        const Weight value = static_cast<Weight>(u * static_cast<double>(stateTotal(table)));
+        size_t t = 0;
+        while (t + 1 < tierCount && value >= table.cumulative[t]) ++t;
+        return t;
     }
 
 private:
-    std::vector<std::shared_ptr<GachaItem>> items;
-    std::vector<double> rates;
-    double totalRate;
-    std::default_random_engine generator;
+    struct RarityTier {
+        int rarity;
+        size_t first;       // index of the tier's first item in items/rates
+        size_t count;
+        Weight itemTotal;   // sum of the tier's item rates
+        bool aliasDirty;
+        bool fenwickDirty;
+        size_t prefixOffset;   // start of the tier's padded block in prefix
+    };
+
+    struct RateState {
+        Weight bonus[MaxTiers];        // per tier, on top of itemTotal
+        Weight cumulative[MaxTiers];   // running tier weights; [tierCount - 1] is the total
+    };
+
+    const Banner* borrowed;      // loaded banner read in place until the first edit, or null
+    std::vector<ItemId> items;   // the pool's own tables, used when borrowed is null
+    std::vector<Weight> rates;
+    RarityTier tiers[MaxTiers];   // sorted by rarity
+    size_t tierCount;
+    Weight totalWeight;
+    RandomEngine generator;
+
+    SamplingMode samplingMode;
+    std::vector<Weight> aliasThreshold;   // coin values below this keep the column
+    std::vector<size_t> aliasIndex;
+    std::vector<Weight> fenwick;          // per-tier 1-based trees laid over each tier's slice
+    std::vector<Weight, AlignedAllocator<Weight, 64> > prefix;   // per-tier inclusive sums, block padded
+    bool prefixDirty;
+
+    RateState states[MaxRateStates];
+    size_t stateCount;
+    size_t currentState;
+    bool stateTablesDirty;
+    bool tablesStale;   // some table above needs prepare() before the next draw
+
+    const ItemId* itemData() const { return borrowed ? borrowed->itemIds : items.data(); }
+    const Weight* rateData() const { return borrowed ? borrowed->itemWeights : rates.data(); }
+
+    // Copies a loaded banner's tables into items/rates before they are edited.
+    void ownTables() {
+        if (!borrowed) return;
+        items.assign(borrowed->itemIds, borrowed->itemIds + borrowed->itemCount);
+        rates.assign(borrowed->itemWeights, borrowed->itemWeights + borrowed->itemCount);
+        borrowed = 0;
+    }
+
+    size_t pushState(const RateState& state) {
+        if (stateCount == MaxRateStates) return npos;
+        states[stateCount] = state;
+        stateTablesDirty = true;
+        tablesStale = true;
+        return stateCount++;
+    }
+
+    size_t findTier(int rarity) const {
+        for (size_t t = 0; t < tierCount; ++t) {
+            if (tiers[t].rarity == rarity) return t;
+        }
+        return npos;
+    }
+
+    size_t insertTier(int rarity) {
+        assert(tierCount < MaxTiers);
+        size_t t = 0;
+        while (t < tierCount && tiers[t].rarity < rarity) ++t;
+        RarityTier tier = { rarity, getItemCount(), 0, 0, true, true, 0 };
+        if (t < tierCount) tier.first = tiers[t].first;
+        for (size_t i = tierCount; i > t; --i) tiers[i] = tiers[i - 1];
+        tiers[t] = tier;
+        for (size_t s = 0; s < stateCount; ++s) {
+            Weight* bonus = states[s].bonus;
+            for (size_t i = tierCount; i > t; --i) bonus[i] = bonus[i - 1];
+            bonus[t] = 0;
+        }
+        tierCount++;
+        return t;
+    }
+
+    Weight bonusTotal(const RateState& state) const {
+        Weight sum = 0;
+        for (size_t t = 0; t < tierCount; ++t) sum += state.bonus[t];
+        return sum;
+    }
+
+    Weight stateTotal(const RateState& state) const { return tierCount ? state.cumulative[tierCount - 1] : 0; }
+
+    void rebuildStateTables() {
+        for (size_t s = 0; s < stateCount; ++s) {
+            RateState& state = states[s];
+            Weight cumulative = 0;
+            for (size_t t = 0; t < tierCount; ++t) {
+                cumulative += tiers[t].itemTotal + state.bonus[t];
+                state.cumulative[t] = cumulative;
+            }
+        }
+        stateTablesDirty = false;
+    }
+
+    size_t tierOf(size_t index) const {
+        size_t t = 0;
+        while (index >= tiers[t].first + tiers[t].count) ++t;
+        return t;
+    }
+
+    template <class Engine>
+    size_t pullTier(Engine& rng, const RateState& state) const {
+        const Weight total = stateTotal(state);
+        if (total == 0) return uniformBelow(rng, tierCount);
+        const Weight randomValue = uniformBelow(rng, total);
+
+        size_t t = 0;
+        while (t + 1 < tierCount && randomValue >= state.cumulative[t]) ++t;
+        return t;
+    }
+
+    // One draw gives both column and coin when count * itemTotal fits.
+    template <class Engine>
+    size_t pullAlias(const RarityTier& tier, Engine& rng) const {
+        size_t column;
+        Weight coin;
+        if (tier.count <= std::numeric_limits<Weight>::max() / tier.itemTotal) {
+            const Weight x = uniformBelow(rng, tier.count * tier.itemTotal);
+            column = static_cast<size_t>(x / tier.itemTotal);
+            coin = x % tier.itemTotal;
+        } else {
+            column = static_cast<size_t>(uniformBelow(rng, tier.count));
+            coin = uniformBelow(rng, tier.itemTotal);
+        }
+        const size_t i = tier.first + column;
+        return coin < aliasThreshold[i] ? i : aliasIndex[i];
+    }
+
+    // Vose's method in integers; every column has height itemTotal.
+    void rebuildAliasTable(RarityTier& tier) {
+        const size_t n = tier.count;
+        const Weight height = tier.itemTotal;
+        const Weight* weights = rateData();
+        aliasThreshold.resize(getItemCount());
+        aliasIndex.resize(getItemCount());
+
+        std::vector<Weight> scaled(n);
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            aliasThreshold[tier.first + i] = height;
+            aliasIndex[tier.first + i] = tier.first + i;
+            scaled[i] = weights[tier.first + i] * n;
+            if (scaled[i] < height) small.push_back(i);
+            else large.push_back(i);
+        }
+
+        while (!small.empty() && !large.empty()) {
+            size_t s = small.back(); small.pop_back();
+            size_t l = large.back(); large.pop_back();
+            aliasThreshold[tier.first + s] = scaled[s];
+            aliasIndex[tier.first + s] = tier.first + l;
+            scaled[l] -= height - scaled[s];
+            if (scaled[l] < height) small.push_back(l);
+            else large.push_back(l);
+        }
+        tier.aliasDirty = false;
+    }
+
+    // Node i (1-based) of a tier's tree is fenwick[tier.first + i - 1].
+    template <class Engine>
+    size_t pullFenwick(const RarityTier& tier, Engine& rng) const {
+        Weight randomValue = uniformBelow(rng, tier.itemTotal);
+
+        size_t step = 1;
+        while (step * 2 <= tier.count) step *= 2;
+
+        size_t pos = 0;
+        for (; step > 0; step /= 2) {
+            size_t next = pos + step;
+            if (next <= tier.count && fenwick[tier.first + next - 1] <= randomValue) {
+                randomValue -= fenwick[tier.first + next - 1];
+                pos = next;
+            }
+        }
+        return tier.first + pos;
+    }
+
+    void fenwickAdd(const RarityTier& tier, size_t local, Weight delta) {
+        for (size_t i = local + 1; i <= tier.count; i += i & (~i + 1)) {
+            fenwick[tier.first + i - 1] += delta;
+        }
+    }
+
+    template <class Engine>
+    size_t pullPrefix(const RarityTier& tier, Engine& rng) const {
+        const Weight randomValue = uniformBelow(rng, tier.itemTotal);
+        return tier.first + prefixSearch(&prefix[tier.prefixOffset], tier.count, randomValue);
+    }
+
+    // Tiers are padded to whole blocks so the kernels read full vectors.
+    void rebuildPrefix() {
+        size_t size = 0;
+        for (size_t t = 0; t < tierCount; ++t) {
+            tiers[t].prefixOffset = size;
+            size += (tiers[t].count + PrefixBlock - 1) / PrefixBlock * PrefixBlock;
+        }
+        prefix.assign(size, PrefixPadding);
+        const Weight* weights = rateData();
+        for (size_t t = 0; t < tierCount; ++t) {
+            Weight cumulative = 0;
+            for (size_t i = 0; i < tiers[t].count; ++i) {
+                cumulative += weights[tiers[t].first + i];
+                prefix[tiers[t].prefixOffset + i] = cumulative;
+            }
+        }
+        prefixDirty = false;
+    }
+
+    void rebuildFenwick(RarityTier& tier) {
+        const Weight* weights = rateData();
+        fenwick.resize(getItemCount());
+        for (size_t i = 1; i <= tier.count; ++i) fenwick[tier.first + i - 1] = weights[tier.first + i - 1];
+        for (size_t i = 1; i <= tier.count; ++i) {
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= tier.count) fenwick[tier.first + parent - 1] += fenwick[tier.first + i - 1];
+        }
+        tier.fenwickDirty = false;
+    }
+};
+
+// Salvage filters for Player::sellWhere: how many copies of a stack to sell.
+struct SellRarityAtMost {
+    int rarity;
+    explicit SellRarityAtMost(int rarity) : rarity(rarity) {}
+    uint32_t operator()(const ItemStack& stack, int itemRarity) const { return itemRarity <= rarity ? stack.count : 0; }
+};
+
+struct SellDuplicatesBeyond {
+    uint32_t keep;
+    explicit SellDuplicatesBeyond(uint32_t keep) : keep(keep) {}
+    uint32_t operator()(const ItemStack& stack, int) const { return stack.count > keep ? stack.count - keep : 0; }
+};
+
+// One player's pity progress and pull counter; picks the pool's rate state.
+struct PityState {
+    static const int Threshold = 5;
+    static const int ResetRarity = 3;   // this rarity or higher resets the counter
+
+    int counter;
+    uint32_t pullCount;   // next pull number for derivePullIndex
+
+    PityState() : counter(0), pullCount(0) {}
+
+    bool active() const { return counter >= Threshold; }
+
+    // A pull under active pity, or of ResetRarity or higher, resets the counter.
+    void update(int rarity) {
+        if (active() || rarity >= ResetRarity) counter = 0;
+        else counter++;
+    }
 };
 
 class Player {
 public:
-    Player(const std::string& name) : name(name), currency(100) {}
+    static const size_t DefaultStackCapacity = 15;
+
+    // Inventory storage comes from arena when given (see Arena.h).
+    Player(const ItemCatalog& catalog, const std::string& name, uint64_t id = 0,
+           size_t stackCapacity = DefaultStackCapacity, Arena* arena = 0)
+        : catalog(&catalog), name(name), id(id), currency(100), inventory(catalog, stackCapacity, arena), events(0) {}
 
-    void addItem(const std::shared_ptr<GachaItem>& item) {
-        inventory.push_back(item);
-        std::cout << "\nObtained: " << item->getName()
-                  << " [" << item->getRarity() << "*]" << std::endl;
+    // Where pulls and sales are reported; none by default.
+    void setEventSink(EventSink* sink) { events = sink; }
+
+    // Sizes the inventory for every catalog item; call once the catalog is filled.
+    void reserveInventory() { inventory.reserveCatalog(); }
+
+    void addItem(ItemId item) {
+        inventory.add(item);
+        post(makeEvent(GameEventType::Pulled, id, item));
+    }
+
+    void addItems(const std::vector<ItemId>& items) {
+        for (size_t i = 0; i < items.size(); ++i) {
+            inventory.add(items[i]);
+            post(makeEvent(GameEventType::Pulled, id, items[i]));
+        }
     }
 
     void showInventory() const {
+        if (events) events->flush();
         std::cout << "\n--- Inventory ---\n";
-        for (size_t i = 0; i < inventory.size(); ++i) {
-            std::cout << i + 1 << ". " << inventory[i]->getName()
-                      << " [" << inventory[i]->getRarity() << "*]" << std::endl;
+        const ArenaVector<ItemStack>& stacks = inventory.getStacks();
+        for (size_t i = 0; i < stacks.size(); ++i) {
+            std::cout << i + 1 << ". " << catalog->getName(stacks[i].item)
+                      << " [" << catalog->getRarity(stacks[i].item) << "*] x" << stacks[i].count << std::endl;
         }
     }
 
-    const std::vector<std::shared_ptr<GachaItem>>& getInventory() const {
+    const Inventory& getInventory() const {
         return inventory;
     }
 
-    bool inventoryIsFull() const { return inventory.size() >= 15; }
+    // O(1) collection queries, answered from the inventory's indices.
+    uint64_t countRarity(int rarity) const { return inventory.getRarityTotal(rarity); }
+    const ArenaVector<ItemId>& getItemsOfRarity(int rarity) const { return inventory.getRarityItems(rarity); }
+    uint32_t countItem(const std::string& itemName) const {
+        const ItemId item = catalog->find(itemName);
+        return item == InvalidItem ? 0 : inventory.count(item);
+    }
+    bool owns(const std::string& itemName) const { return countItem(itemName) != 0; }
+
+    // Held items, oldest acquisition first.
+    void getAcquisitionOrder(std::vector<ItemId>& out) const {
+        out.clear();
+        for (ItemId item = inventory.firstAcquired(); item != InvalidItem; item = inventory.nextAcquired(item)) {
+            out.push_back(item);
+        }
+    }
+
+    // Full means no free stack: the next pull could be a new item with nowhere to go.
+    bool inventoryIsFull() const { return inventory.isFull(); }
+    size_t getFreeSlots() const { return inventory.getFreeStacks(); }
+    void setInventoryCapacity(size_t stacks) { inventory.setStackCapacity(stacks); }
     bool canPull(int cost) const { return currency >= cost; }
 
     void spendCurrency(int amount) { currency -= amount; }
     void earnCurrency(int amount) { currency += amount; }
     int getCurrency() const { return currency; }
+    uint64_t getId() const { return id; }
+    PityState& getPity() { return pity; }
+    const PityState& getPity() const { return pity; }
 
+    // Sells one copy from the index-th stack shown by showInventory (1-based).
     void sellItem(int index) {
-        if (index < 1 || index > static_cast<int>(inventory.size())) {
-            std::cout << "Invalid item selection!" << std::endl;
+        if (index < 1 || index > static_cast<int>(inventory.getStackCount())) {
+            post(makeEvent(GameEventType::InvalidSelection, id));
             return;
         }
-        auto item = inventory[index - 1];
-        int sellValue = getSellValue(item->getRarity());
-        inventory.erase(inventory.begin() + index - 1);
+        sellItem(inventory.getStackHandle(index - 1));
+    }
+
+    // Sells up to count copies; a stale handle sells nothing.
+    uint32_t sellItem(SlotHandle handle, uint32_t count = 1) {
+        const ItemStack* stack = inventory.getStack(handle);
+        if (!stack) return 0;
+        return sellCopies(stack->item, count);
+    }
+
+    // Sells up to count copies of item in O(1) and returns how many were sold.
+    uint32_t sellCopies(ItemId item, uint32_t count) {
+        uint32_t sold = inventory.remove(item, count);
+        if (sold == 0) return 0;
+        int sellValue = getSellValue(catalog->getRarity(item)) * static_cast<int>(sold);
         currency += sellValue;
-        std::cout << "Sold: " << item->getName() << " for " << sellValue << " currency.\n";
+        post(makeEvent(GameEventType::Sold, id, item, sold, sellValue));
+        return sold;
     }
 
-private:
-    std::string name;
-    int currency;
-    std::vector<std::shared_ptr<GachaItem>> inventory;
+    // Sells what filter selects in one pass and credits the total once.
+    template <class Filter>
+    int sellWhere(Filter filter) {
+        uint32_t sold = 0;
+        int earned = 0;
+        // Backwards, since an emptied stack is replaced by the last one.
+        for (size_t i = inventory.getStackCount(); i-- > 0; ) {
+            const ItemStack& stack = inventory.getStacks()[i];
+            const int rarity = catalog->getRarity(stack.item);
+            uint32_t count = filter(stack, rarity);
+            if (count == 0) continue;
+            count = inventory.remove(inventory.getStackHandle(i), count);
+            sold += count;
+            earned += getSellValue(rarity) * static_cast<int>(count);
+        }
+        currency += earned;
+        post(makeEvent(GameEventType::Salvaged, id, InvalidItem, sold, earned));
+        return earned;
+    }
 
     static int getSellValue(int rarity) {
         switch (rarity) {
@@ -121,32 +669,54 @@ private:
             default: return 0;
         }
     }
+
+private:
+    const ItemCatalog* catalog;
+    std::string name;
+    uint64_t id;
+    int currency;
+    Inventory inventory;
+    PityState pity;
+    EventSink* events;
+
+    void post(const GameEvent& event) const {
+        if (events) events->post(event);
+    }
 };
 
 class GachaGame {
 public:
-    GachaGame() : player("Player"), pityCounter(0) {}
+    // Reports to the console unless another event backend is given.
+    explicit GachaGame(std::unique_ptr<EventBackend> backend = std::unique_ptr<EventBackend>())
+        : events(backend ? std::move(backend) : std::unique_ptr<EventBackend>(new ConsoleEventBackend(catalog))),
+          player(catalog, "Player"), pityRateState(0), bannerSeed(nondeterministicSeed()) {
+        player.setEventSink(&events);
+    }
 
     void run() {
         setupPool();
 
         int choice;
         do {
+            events.flush();
             std::cout << "\n=== Gacha Game Menu ===\n";
             std::cout << "1. Pull (Cost: 10)\n";
             std::cout << "2. Show Inventory\n";
             std::cout << "3. Show Currency\n";
             std::cout << "4. Sell Item\n";
+            std::cout << "5. Pull x10 (Cost: 100)\n";
+            std::cout << "6. Salvage Duplicates\n";
             std::cout << "0. Exit\n";
             std::cout << "Choice: ";
             std::cin >> choice;
 
             switch (choice) {
                 case 1: {
-                    auto item = pullGacha();
-                    if (item) {
-                        std::cout << "Pulled: " << item->getName()
-                                  << " [" << item->getRarity() << "]\n";
+                    ItemId item = pullGacha();
+                    if (item != InvalidItem) {
+                        events.flush();
+                        std::cout << "Pulled: " << catalog.getName(item)
+                                  << " [" << catalog.getRarity(item) << "]\n";
                     }
                     break;
                 }
@@ -166,6 +736,12 @@ public:
                     } while (itemNum != 0);
                     break;
                 }
+                case 5:
+                    pullGachaBatch(10);
+                    break;
+                case 6:
+                    player.sellWhere(SellDuplicatesBeyond(1));
+                    break;
                 case 0:
                     std::cout << "\nGoodbye!\n";
                     break;
@@ -176,108 +752,126 @@ public:
         } while (choice != 0);
     }
 
+    // The catalog and pool read the compile-time banner in place.
     void setupPool() {
-        // Rarity totals
-        std::map<int, double> rarityProb;
-        rarityProb[1] = 80.0;
-        rarityProb[2] = 25.0;
-        rarityProb[3] = 15.0;
-        rarityProb[4] = 7.0;
-        rarityProb[5] = 1.9;
-        rarityProb[6] = 0.01;
-
-        // Items per rarity
-        std::map<int, std::vector<std::string> > items;
-        items[1].push_back("Common Sword");
-        items[1].push_back("Rusty Dagger");
-        items[1].push_back("Wooden Ladle");
-        items[1].push_back("Tree Branch");
-        items[1].push_back("Small Rock");
-        items[1].push_back("Wooden Club");
-        items[1].push_back("Common Spear");
-
-        items[2].push_back("Torch");
-        items[2].push_back("Kitchen Knife");
-        items[2].push_back("Skeleton Arm");
-        items[2].push_back("Reinforced Sword");
-        items[2].push_back("Reinforced Spear");
-
-        items[3].push_back("Rare Spear");
-        items[3].push_back("Fire Sword");
-        items[3].push_back("Ice Sword");
-        items[3].push_back("Rare Claymore");
-
-        items[4].push_back("Epic Staff");
-        items[4].push_back("Fire Claymore");
-        items[4].push_back("Ice Claymore");
-
-        items[5].push_back("Legendary Blade");
-        items[5].push_back("Sword of Sparda");
-
-        items[6].push_back("Master Sword");
-
-        // Distribute rates
-        for (std::map<int, std::vector<std::string> >::iterator it = items.begin(); it != items.end(); ++it) {
-            int rarity = it->first;
-            std::vector<std::string>& names = it->second;
-            double ratePerItem = rarityProb[rarity] / names.size();
-            for (size_t i = 0; i < names.size(); ++i) {
-                pool.addItem(std::make_shared<GachaItem>(names[i], rarity), ratePerItem);
-            }
+        {
+#ifdef GACHA_COUNT_ALLOCATIONS
+            AllocationGuard guard("GachaGame::setupPool");
+#endif
+            catalog.bindBanner(DefaultBanner);
+            pityRateState = pool.loadBanner(DefaultBanner, catalog);
+            pool.prepare();
         }
+        player.reserveInventory();
     }
 
     Player& getPlayer() { return player; }
+    const ItemCatalog& getCatalog() const { return catalog; }
+    EventSink& getEvents() { return events; }
+    // Read-only once setupPool has run; players share it.
+    const GachaPool& getPool() const { return pool; }
+    size_t getPityRateState() const { return pityRateState; }
 
-    std::shared_ptr<GachaItem> pullGacha() {
-        const int cost = 10;
+    ItemId pullGacha() {
         if (player.inventoryIsFull()) {
-            std::cout << "Please sell to make space!" << std::endl;
-            return nullptr;
+            events.post(makeEvent(GameEventType::InventoryFull, player.getId()));
+            return InvalidItem;
         }
 
-        if (player.canPull(cost)) {
-            auto item = pool.pull();
+        if (player.canPull(pullCost)) {
+            if (pool.empty()) {
+                events.post(makeEvent(GameEventType::PoolEmpty, player.getId()));
+                return InvalidItem;
+            }
+#ifdef GACHA_COUNT_ALLOCATIONS
+            AllocationGuard guard("GachaGame::pullGacha");
+#endif
+            const bool pityWasActive = player.getPity().active();
+            ItemId item = drawFor(player);
             player.addItem(item);
-            player.spendCurrency(cost);
+            player.spendCurrency(pullCost);
+            reportPity(player, pityWasActive);
 
-            if (pityCounter >= 5) {
-                pityCounter = 0;
-                decreaseHighRarityOdds();
-            }
-            else if (item->getRarity() >= 3) pityCounter = 0;
-            else pityCounter++;
+            return item;
+        }
+        events.post(makeEvent(GameEventType::InsufficientFunds, player.getId()));
+        return InvalidItem;
+    }
 
-            if (pityCounter >= 5) increaseHighRarityOdds();
+    // Pulls up to n items, fewer if currency or inventory space runs out.
+    std::vector<ItemId> pullGachaBatch(int n) {
+        std::vector<ItemId> pulled;
+        pullGachaBatch(n, pulled);
+        return pulled;
+    }
 
-            return item;
+    // As above, into pulled (cleared first); returns the number pulled.
+    int pullGachaBatch(int n, std::vector<ItemId>& pulled) {
+        pulled.clear();
+        if (n <= 0) return 0;
+        if (pool.empty()) {
+            events.post(makeEvent(GameEventType::PoolEmpty, player.getId()));
+            return 0;
+        }
+        int count = n;
+        if (count > static_cast<int>(player.getFreeSlots())) count = static_cast<int>(player.getFreeSlots());
+        if (count > player.getCurrency() / pullCost) count = player.getCurrency() / pullCost;
+        if (count == 0) {
+            events.post(makeEvent(player.inventoryIsFull() ? GameEventType::InventoryFull
+                                                           : GameEventType::InsufficientFunds, player.getId()));
+            return 0;
+        }
+
+        pulled.reserve(count);
+        const bool pityWasActive = player.getPity().active();
+        for (int i = 0; i < count; ++i) pulled.push_back(drawFor(player));
+
+        player.addItems(pulled);
+        player.spendCurrency(count * pullCost);
+        reportPity(player, pityWasActive);
+        if (count < n) {
+            events.post(makeEvent(GameEventType::PartialBatch, player.getId(), InvalidItem, count, n));
         }
-        std::cout << "You cannot afford anymore. ☹️" << std::endl;
-        return nullptr;
+        return count;
+    }
+
+    // Recomputes a past pull from its number and whether pity was active.
+    ItemId replayPull(uint32_t pullNumber, bool pityActive) const {
+        return pool.getItem(pool.derivePullIndex(bannerSeed, player.getId(), pullNumber, pityActive ? pityRateState : 0));
+    }
+
+    // One pull for player from a shared pool; cost and space are not checked.
+    static ItemId drawFor(const GachaPool& pool, size_t pityRateState, uint64_t bannerSeed,
+                          const ItemCatalog& catalog, uint64_t player, PityState& pity) {
+        const size_t state = pity.active() ? pityRateState : 0;
+        const ItemId item = pool.getItem(pool.derivePullIndex(bannerSeed, player, pity.pullCount++, state));
+        pity.update(catalog.getRarity(item));
+        return item;
     }
 
+    static int getPullCost() { return pullCost; }
+
+    void setBannerSeed(uint64_t seed) { bannerSeed = seed; }
+    uint64_t getBannerSeed() const { return bannerSeed; }
+    uint32_t getPullCount() const { return player.getPity().pullCount; }
+
 private:
+    static const int pullCost = 10;
+
+    ItemCatalog catalog;
+    EventSink events;
     GachaPool pool;
     Player player;
-    int pityCounter;
+    size_t pityRateState;   // pool rate state used while a player's pity is active
+    uint64_t bannerSeed;
 
-    void increaseHighRarityOdds() {
-        std::cout << "\nPity system activated, odds increased!" << std::endl;
-        for (size_t i = 0; i < pool.getItems().size(); ++i) {
-            auto item = pool.getItems()[i];
-            if (item->getRarity() == 4) pool.increaseRate(i, 50.0);
-            if (item->getRarity() == 5) pool.increaseRate(i, 20.0);
-            if (item->getRarity() == 6) pool.increaseRate(i, 10.0);
-        }
+    ItemId drawFor(Player& who) const {
+        return drawFor(pool, pityRateState, bannerSeed, catalog, who.getId(), who.getPity());
     }
 
-    void decreaseHighRarityOdds() {
-        std::cout << "\nPity system deactivated!" << std::endl;
-        for (size_t i = 0; i < pool.getItems().size(); ++i) {
-            auto item = pool.getItems()[i];
-            if (item->getRarity() == 4) pool.decreaseRate(i, 50.0);
-            if (item->getRarity() == 5) pool.decreaseRate(i, 20.0);
-            if (item->getRarity() == 6) pool.decreaseRate(i, 10.0);
-        }
+    void reportPity(const Player& who, bool wasActive) {
+        const bool isActive = who.getPity().active();
+        if (wasActive && !isActive) events.post(makeEvent(GameEventType::PityOff, who.getId()));
+        if (!wasActive && isActive) events.post(makeEvent(GameEventType::PityOn, who.getId()));
     }
 };
@@ -0,0 +1,94 @@
+// Headless simulator (no raylib): runs every engine on the default banner,
+// prints its estimates next to PityChain's exact values, and exits nonzero if
+// an estimate is more than five standard errors off.
+//
+//   GachaSim [sessions] [threads]     threads 0: one per hardware thread
+#include <cstdlib>
+#include <iostream>
+#include "LaneSimulation.h"
+#include "PityChain.h"
+#include "RareEventSimulation.h"
+#include "StratifiedSimulation.h"
+#include "tests/Check.h"
+
+static const double Sigmas = 5.0;
+
+// Sessions of exactly pullsPerSession pulls from a fresh counter; binomial
+// standard errors per rarity.
+static void checkRarityCounts(const SimulationStats& stats, const PityChain& chain, uint32_t pullsPerSession) {
+    std::cout << "  exact:";
+    for (int r = 1; r <= MaxRarity; ++r) {
+        const double expected = chain.expectedCount(r, pullsPerSession) * stats.sessions;
+        const double p = expected / stats.pulls;
+        std::cout << " " << r << "* " << p;
+        CHECK_NEAR(double(stats.rarityCounts[r]), expected, std::sqrt(stats.pulls * p * (1.0 - p)), Sigmas);
+    }
+    std::cout << "\n";
+}
+
+int main(int argc, char** argv) {
+    const uint64_t sessions = argc > 1 ? std::strtoull(argv[1], 0, 10) : 100000;
+    const unsigned threads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 0;
+
+    const HeadlessGame game;
+    const GachaPool& pool = game.getPool();
+    const size_t pity = game.getPityRateState();
+    const PityChain chain(pool, pity);
+    std::cout << "== PityChain (exact)\n";
+    chain.print(std::cout);
+
+    // No salvage and room for every item, so only currency ends a session.
+    const uint32_t PullsPerSession = 200;
+    SimulationConfig config;
+    config.sessions = sessions;
+    config.threads = threads;
+    config.startingCurrency = PullsPerSession * GachaGame::getPullCost();
+    config.salvageRarity = 0;
+    config.stackCapacity = game.getCatalog().size() + 1;
+
+    std::cout << "\n== Simulation, " << PullsPerSession << " pulls per session\n";
+    const SimulationResult exactRules = Simulation(pool, game.getCatalog(), pity).run(config);
+    exactRules.print(std::cout);
+    checkRarityCounts(exactRules.stats, chain, PullsPerSession);
+
+    std::cout << "\n== LaneSimulation, " << PullsPerSession << " pulls per session\n";
+    const SimulationResult lanes = LaneSimulation(pool, pity).run(config);
+    lanes.print(std::cout);
+    checkRarityCounts(lanes.stats, chain, PullsPerSession);
+
+    std::cout << "\n== RareEventSimulation\n";
+    RareEventConfig rareConfig;
+    rareConfig.sessions = sessions;
+    rareConfig.threads = threads;
+    rareConfig.minHits = 3;
+    const RareEventResult rare = RareEventSimulation(pool, pity).run(rareConfig);
+    rare.print(std::cout);
+    CHECK_NEAR(rare.stats.hits.mean(), rare.expectedHits, rare.stats.hits.standardError(), Sigmas);
+
+    // E[min(T, cap)] for the first-hit time T is the sum of its survival function.
+    std::cout << "\n== StratifiedSimulation\n";
+    StratifiedConfig stratifiedConfig;
+    stratifiedConfig.sessions = sessions / stratifiedConfig.replicates;
+    stratifiedConfig.threads = threads;
+    const std::vector<double> firstHit = chain.pullsToDistribution(stratifiedConfig.targetRarity,
+                                                                   stratifiedConfig.pullCap, true);
+    double survival = 1.0, expectedPulls = 0.0;
+    for (uint32_t k = 1; k <= stratifiedConfig.pullCap; ++k) {
+        expectedPulls += survival;
+        survival -= firstHit[k];
+    }
+    const double exactCost = expectedPulls * stratifiedConfig.pullCost;
+    std::cout << "exact: cost to " << stratifiedConfig.targetRarity << "* = " << exactCost << ", reached "
+              << 1.0 - survival << "\n";
+    const StratifiedSimulation stratified(pool, pity);
+    const UniformSource sources[] = { UniformSource::Pseudo, UniformSource::LatinHypercube, UniformSource::Halton };
+    StratifiedResult baseline;
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); ++i) {
+        const StratifiedResult result = stratified.run(stratifiedConfig, sources[i]);
+        result.print(std::cout, i ? &baseline : 0);
+        if (i == 0) baseline = result;
+        CHECK_NEAR(result.meanCost(), exactCost, result.costStandardError(), Sigmas);
+        CHECK_NEAR(result.hitProbability(), 1.0 - survival, result.hitStandardError(), Sigmas);
+    }
+    return checkResult("GachaSim");
+}
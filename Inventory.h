@@ -0,0 +1,165 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "ItemCatalog.h"
+#include "SlotMap.h"
+
+struct ItemStack {
+    ItemId item;
+    uint32_t count;
+};
+
+// One stack per distinct item, in a slot map; capacity is counted in stacks.
+// Per-rarity totals and the acquisition order are updated in O(1).
+class Inventory {
+public:
+    Inventory(const ItemCatalog& catalog, size_t stackCapacity, Arena* arena = 0)
+        : catalog(&catalog), stackCapacity(stackCapacity), copies(0), links(ArenaAllocator<ItemLinks>(arena)),
+          oldest(InvalidItem), newest(InvalidItem), stacks(arena) {
+        for (int r = 0; r <= MaxRarity; ++r) {
+            rarityTotals[r] = 0;
+            rarityItems[r] = ArenaVector<ItemId>(ArenaAllocator<ItemId>(arena));
+        }
+        stacks.reserve(stackCapacity);
+    }
+
+    // Sizes the per-item links table, 20 bytes per catalog item for each
+    // inventory, so later adds never allocate. Call after the catalog is filled.
+    void reserveCatalog() {
+        if (links.size() >= catalog->size()) return;
+        ItemLinks unheld = { InvalidSlot, 0, InvalidItem, InvalidItem };
+        links.resize(catalog->size(), unheld);
+        size_t perRarity[MaxRarity + 1] = {};
+        for (size_t i = 0; i < catalog->size(); ++i) perRarity[rarityOf(static_cast<ItemId>(i))]++;
+        for (int r = 0; r <= MaxRarity; ++r) rarityItems[r].reserve(perRarity[r]);
+    }
+
+    // Fails when the item is not in the catalog, or needs a new stack and all
+    // stacks are in use.
+    bool add(ItemId item, uint32_t count = 1) {
+        if (item >= links.size()) {
+            reserveCatalog();
+            if (item >= links.size()) return false;
+        }
+        if (count == 0) return true;
+        ItemStack* stack = stacks.get(links[item].stack);
+        if (!stack) {
+            if (stacks.size() >= stackCapacity) return false;
+            ItemStack fresh = { item, 0 };
+            links[item].stack = stacks.insert(fresh);
+            stack = stacks.get(links[item].stack);
+            link(item);
+        }
+        stack->count += count;
+        rarityTotals[rarityOf(item)] += count;
+        copies += count;
+        return true;
+    }
+
+    // Removes up to count copies and returns how many were removed. An emptied
+    // stack is dropped and its handle goes stale.
+    uint32_t remove(ItemId item, uint32_t count = 1) {
+        return remove(findStack(item), count);
+    }
+
+    uint32_t remove(SlotHandle handle, uint32_t count = 1) {
+        ItemStack* stack = stacks.get(handle);
+        if (!stack) return 0;
+        if (count > stack->count) count = stack->count;
+
+        const ItemId item = stack->item;
+        stack->count -= count;
+        rarityTotals[rarityOf(item)] -= count;
+        copies -= count;
+        if (stack->count == 0) {
+            stacks.remove(handle);
+            links[item].stack = InvalidSlot;
+            unlink(item);
+        }
+        return count;
+    }
+
+    uint32_t count(ItemId item) const {
+        const ItemStack* stack = stacks.get(findStack(item));
+        return stack ? stack->count : 0;
+    }
+    bool contains(ItemId item) const { return count(item) != 0; }
+    uint64_t getRarityTotal(int rarity) const { return validRarity(rarity) ? rarityTotals[rarity] : 0; }
+    uint64_t getCopyCount() const { return copies; }
+
+    // Held items of one rarity, in no particular order.
+    const ArenaVector<ItemId>& getRarityItems(int rarity) const { return rarityItems[validRarity(rarity) ? rarity : 0]; }
+
+    // Held items in the order they were first acquired (an item that is sold
+    // out and pulled again moves to the back). Walk with nextAcquired until
+    // InvalidItem.
+    ItemId firstAcquired() const { return oldest; }
+    ItemId nextAcquired(ItemId item) const { return links[item].next; }
+
+    // InvalidSlot when the item is not held.
+    SlotHandle findStack(ItemId item) const { return item < links.size() ? links[item].stack : InvalidSlot; }
+    const ItemStack* getStack(SlotHandle handle) const { return stacks.get(handle); }
+
+    // Dense list of stacks for rendering; the order changes when a stack empties.
+    const ArenaVector<ItemStack>& getStacks() const { return stacks.values(); }
+    SlotHandle getStackHandle(size_t index) const { return stacks.handleAt(index); }
+    size_t getStackCount() const { return stacks.size(); }
+    size_t getStackCapacity() const { return stackCapacity; }
+    // Reserves up front so pulls into the new stacks stay allocation-free.
+    void setStackCapacity(size_t capacity) {
+        stackCapacity = capacity;
+        stacks.reserve(capacity);
+    }
+    bool isFull() const { return stacks.size() >= stackCapacity; }
+    size_t getFreeStacks() const { return isFull() ? 0 : stackCapacity - stacks.size(); }
+
+private:
+    const ItemCatalog* catalog;
+    size_t stackCapacity;
+    uint64_t copies;
+    uint64_t rarityTotals[MaxRarity + 1];
+    ArenaVector<ItemId> rarityItems[MaxRarity + 1];
+
+    struct ItemLinks {
+        SlotHandle stack;      // InvalidSlot while not held
+        uint32_t rarityIndex;  // position in rarityItems while held
+        ItemId prev, next;     // acquisition order while held
+    };
+
+    ArenaVector<ItemLinks> links;   // per ItemId
+    ItemId oldest, newest;
+    SlotMap<ItemStack> stacks;
+
+    static bool validRarity(int rarity) { return rarity >= 0 && rarity <= MaxRarity; }
+
+    int rarityOf(ItemId item) const {
+        const int rarity = catalog->getRarity(item);
+        return rarity <= MaxRarity ? rarity : 0;
+    }
+
+    void link(ItemId item) {
+        ArenaVector<ItemId>& list = rarityItems[rarityOf(item)];
+        links[item].rarityIndex = static_cast<uint32_t>(list.size());
+        list.push_back(item);
+
+        links[item].prev = newest;
+        links[item].next = InvalidItem;
+        if (newest != InvalidItem) links[newest].next = item;
+        else oldest = item;
+        newest = item;
+    }
+
+    void unlink(ItemId item) {
+        ArenaVector<ItemId>& list = rarityItems[rarityOf(item)];
+        const uint32_t index = links[item].rarityIndex;
+        list[index] = list.back();
+        links[list[index]].rarityIndex = index;
+        list.pop_back();
+
+        const ItemId prev = links[item].prev, next = links[item].next;
+        if (prev != InvalidItem) links[prev].next = next;
+        else oldest = next;
+        if (next != InvalidItem) links[next].prev = prev;
+        else newest = prev;
+    }
+};
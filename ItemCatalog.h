@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Banner.h"
+
+typedef uint32_t ItemId;
+
+static const ItemId InvalidItem = 0xffffffffu;
+
+static const int MaxRarity = 6;   // rarities run 1 (Common) to 6 (Mythical)
+
+// Every item's name and rarity, interned once and shared read-only. A bound
+// banner's items keep their banner indices as ids; later items follow them.
+class ItemCatalog {
+public:
+    ItemCatalog() : bannerItems(0), bannerNameOrder(0), bannerCount(0) {}
+
+    // Call on an empty catalog; the banner must outlive it.
+    void bindBanner(const Banner& banner) {
+        bannerItems = banner.items;
+        bannerNameOrder = banner.nameOrder;
+        bannerCount = banner.itemCount;
+    }
+
+    bool isBoundTo(const Banner& banner) const { return bannerItems != 0 && bannerItems == banner.items; }
+
+    // Returns the id already interned under name (keeping its first rarity),
+    // or interns a new item.
+    ItemId intern(const std::string& name, int rarity) {
+        const ItemId found = find(name);
+        if (found != InvalidItem) return found;
+
+        const ItemId id = static_cast<ItemId>(size());
+        names.push_back(name);
+        rarities.push_back(static_cast<uint8_t>(rarity));
+        ids[name] = id;
+        return id;
+    }
+
+    // Binary search over the banner's name order, then the interned items.
+    ItemId find(const std::string& name) const {
+        size_t low = 0, high = bannerCount;
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (std::strcmp(bannerItems[bannerNameOrder[mid]].name, name.c_str()) < 0) low = mid + 1;
+            else high = mid;
+        }
+        if (low < bannerCount && std::strcmp(bannerItems[bannerNameOrder[low]].name, name.c_str()) == 0) {
+            return bannerNameOrder[low];
+        }
+        std::unordered_map<std::string, ItemId>::const_iterator it = ids.find(name);
+        return it == ids.end() ? InvalidItem : it->second;
+    }
+
+    const char* getName(ItemId id) const {
+        return id < bannerCount ? bannerItems[id].name : names[id - bannerCount].c_str();
+    }
+
+    int getRarity(ItemId id) const {
+        return id < bannerCount ? bannerItems[id].rarity : rarities[id - bannerCount];
+    }
+
+    size_t size() const { return bannerCount + names.size(); }
+
+private:
+    const BannerItem* bannerItems;   // bound banner's table, or null
+    const uint32_t* bannerNameOrder;
+    size_t bannerCount;
+    std::vector<std::string> names;   // items interned beyond the banner
+    std::vector<uint8_t> rarities;
+    std::unordered_map<std::string, ItemId> ids;
+};
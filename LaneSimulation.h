@@ -0,0 +1,397 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "Parallel.h"
+#include "Simulation.h"
+
+// Rarity-level sessions, one per SIMD lane. Unlike Simulation.h, items of
+// rarity <= salvageRarity are sold as soon as they are pulled, there is no
+// stack cap, and uniforms are a 32-bit hash of the session key and pull number.
+// The scalar, AVX2 and AVX-512 kernels give bit-identical results.
+
+struct LaneModel {
+    // Per-tier and per-rarity tables are padded to one 8-lane permute.
+    static const int TableSize = 8;
+    static_assert(GachaPool::MaxTiers <= TableSize && MaxRarity < TableSize, "tables must fit one permute");
+
+    // Tier t is drawn when boundary[t - 1] <= u < boundary[t]; only the first
+    // tierCount - 1 boundaries are used.
+    uint32_t normalBoundary[GachaPool::MaxTiers];
+    uint32_t pityBoundary[GachaPool::MaxTiers];
+    int32_t tierRarity[TableSize];
+    int32_t sellValue[TableSize];         // per rarity, credited when that rarity is pulled
+    int tierCount;
+    int32_t pullCost;
+    int32_t startingCurrency;
+    int32_t pityThreshold;
+    uint32_t maxSteps;                    // SimulationConfig::maxPulls
+    uint64_t bannerSeed;
+
+    LaneModel(const GachaPool& pool, size_t pityRateState, const SimulationConfig& config)
+        : tierCount(static_cast<int>(pool.getTierCount())), pullCost(config.pullCost),
+          startingCurrency(config.startingCurrency), pityThreshold(PityState::Threshold),
+          maxSteps(config.maxPulls), bannerSeed(config.bannerSeed) {
+        assert(pool.isPrepared() && pool.getTierCount() <= GachaPool::MaxTiers);
+        for (size_t t = 0; t < GachaPool::MaxTiers; ++t) normalBoundary[t] = pityBoundary[t] = 0xffffffffu;
+        for (int t = 0; t < TableSize; ++t) {
+            tierRarity[t] = t < tierCount ? pool.getTierRarity(t) : 0;
+            sellValue[t] = t <= MaxRarity && t <= config.salvageRarity ? Player::getSellValue(t) : 0;
+        }
+        setBoundaries(pool, 0, normalBoundary);
+        setBoundaries(pool, pityRateState, pityBoundary);
+    }
+
+    // Per-lane stream key for a session. It is 64 bits wide: with 32, about
+    // one session in a thousand shares a key, and so a trajectory, with
+    // another at 10^7 sessions.
+    uint64_t sessionKey(uint64_t session) const {
+        return SplitMix64(bannerSeed ^ (session * 0x9e3779b97f4a7c15ULL))();
+    }
+
+    // The uniform for one pull: both key halves go through the mix, so keys
+    // that agree in one half still give unrelated streams.
+    static uint32_t uniform(uint32_t keyLow, uint32_t keyHigh, uint32_t stepWord) {
+        return mix(mix(keyLow ^ stepWord) ^ keyHigh);
+    }
+
+    // Shared by every lane at pull number step.
+    uint32_t stepWord(uint32_t step) const {
+        return mix(static_cast<uint32_t>(bannerSeed >> 32) ^ (step * 0x9e3779b9u + static_cast<uint32_t>(bannerSeed)));
+    }
+
+    // murmur3 finalizer
+    static uint32_t mix(uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+private:
+    void setBoundaries(const GachaPool& pool, size_t state, uint32_t* boundary) const {
+        const double total = static_cast<double>(pool.getStateTotalWeight(state));
+        GachaPool::Weight cumulative = 0;
+        for (int t = 0; t + 1 < tierCount; ++t) {
+            cumulative += pool.getTierWeight(t, state);
+            const double scaled = static_cast<double>(cumulative) / total * 4294967296.0;
+            boundary[t] = scaled >= 4294967295.0 ? 0xffffffffu : static_cast<uint32_t>(scaled);
+        }
+    }
+};
+
+// One chunk of lanes, laid out column-wise. Lanes past count start broke.
+struct LaneChunk {
+    static const size_t Lanes = 1024;
+
+    alignas(64) int32_t currency[Lanes];
+    alignas(64) int32_t pity[Lanes];
+    alignas(64) int32_t lastRarity[Lanes];
+    alignas(64) uint32_t keyLow[Lanes];
+    alignas(64) uint32_t keyHigh[Lanes];
+    alignas(64) uint32_t firstTop[Lanes];   // pull number of the first MaxRarity item, 0 if none
+    size_t count;
+
+    void reset(const LaneModel& model, uint64_t firstSession, size_t sessions) {
+        count = sessions;
+        for (size_t i = 0; i < Lanes; ++i) {
+            currency[i] = i < sessions ? model.startingCurrency : 0;
+            pity[i] = 0;
+            lastRarity[i] = 0;
+            const uint64_t key = model.sessionKey(firstSession + i);
+            keyLow[i] = static_cast<uint32_t>(key);
+            keyHigh[i] = static_cast<uint32_t>(key >> 32);
+            firstTop[i] = 0;
+        }
+    }
+};
+
+// Plain per-lane version, also the reference for the vector kernels.
+inline void laneKernelScalar(const LaneModel& m, LaneChunk& c, SimulationStats& stats) {
+    for (size_t i = 0; i < c.count; ++i) {
+        int32_t currency = c.currency[i], last = c.lastRarity[i];
+        uint32_t firstTop = c.firstTop[i], pulls = 0;
+        PityState pity;
+        pity.counter = c.pity[i];
+        for (uint32_t step = 0; step < m.maxSteps && currency >= m.pullCost; ++step) {
+            const uint32_t u = LaneModel::uniform(c.keyLow[i], c.keyHigh[i], m.stepWord(step));
+            const bool pityOn = pity.active();
+            int tier = 0;
+            for (int t = 0; t + 1 < m.tierCount; ++t) tier += u >= (pityOn ? m.pityBoundary[t] : m.normalBoundary[t]);
+            last = m.tierRarity[tier];
+            pity.update(last);
+            currency += m.sellValue[last] - m.pullCost;
+            stats.currencyEarned += m.sellValue[last];
+            stats.pityPulls += pityOn;
+            stats.rarityCounts[last]++;
+            ++pulls;
+            if (last == MaxRarity && firstTop == 0) firstTop = pulls;
+        }
+        c.currency[i] = currency;
+        c.pity[i] = pity.counter;
+        c.lastRarity[i] = last;
+        c.firstTop[i] = firstTop;
+        stats.pulls += pulls;
+        stats.currencySpent += static_cast<uint64_t>(pulls) * m.pullCost;
+        if (firstTop) {
+            stats.sessionsWithTopRarity++;
+            stats.pullsToFirstTopRarity += firstTop;
+        }
+        if (currency >= m.pullCost) stats.sessionsAtPullLimit++;
+    }
+    stats.sessions += c.count;
+}
+
+#ifdef GACHA_X86_DISPATCH
+__attribute__((target("avx2")))
+inline __m256i laneMixAvx2(__m256i h) {
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0x85ebca6bu)));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32(static_cast<int>(0xc2b2ae35u)));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+__attribute__((target("avx2")))
+inline uint64_t laneSumAvx2(__m256i v) {
+    alignas(32) uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    uint64_t sum = 0;
+    for (int i = 0; i < 8; ++i) sum += lanes[i];
+    return sum;
+}
+
+__attribute__((target("avx2")))
+inline void laneKernelAvx2(const LaneModel& m, LaneChunk& c, SimulationStats& stats) {
+    // AVX2 only compares signed, so unsigned uniforms and boundaries are
+    // compared with their top bit flipped.
+    const __m256i bias = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    __m256i normalB[GachaPool::MaxTiers], pityB[GachaPool::MaxTiers];
+    for (size_t t = 0; t < GachaPool::MaxTiers; ++t) {
+        normalB[t] = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(m.normalBoundary[t])), bias);
+        pityB[t] = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int>(m.pityBoundary[t])), bias);
+    }
+    const __m256i rarityTable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m.tierRarity));
+    const __m256i sellTable = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m.sellValue));
+    const __m256i one = _mm256_set1_epi32(1), resetMinusOne = _mm256_set1_epi32(PityState::ResetRarity - 1);
+    const __m256i costMinusOne = _mm256_set1_epi32(m.pullCost - 1), cost = _mm256_set1_epi32(m.pullCost);
+    const __m256i thresholdMinusOne = _mm256_set1_epi32(m.pityThreshold - 1);
+    const __m256i top = _mm256_set1_epi32(MaxRarity), zero = _mm256_setzero_si256();
+
+    for (size_t i = 0; i < c.count; i += 8) {
+        __m256i currency = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.currency + i));
+        __m256i pity = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.pity + i));
+        __m256i last = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.lastRarity + i));
+        __m256i firstTop = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.firstTop + i));
+        const __m256i keyLow = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.keyLow + i));
+        const __m256i keyHigh = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.keyHigh + i));
+        __m256i pulls = zero, pityPulls = zero, earned = zero;
+        __m256i counts[MaxRarity + 1];
+        for (int r = 0; r <= MaxRarity; ++r) counts[r] = zero;
+
+        for (uint32_t step = 0; step < m.maxSteps; ++step) {
+            const __m256i active = _mm256_cmpgt_epi32(currency, costMinusOne);
+            if (_mm256_testz_si256(active, active)) break;
+
+            const __m256i word = _mm256_xor_si256(keyLow, _mm256_set1_epi32(static_cast<int>(m.stepWord(step))));
+            const __m256i u = _mm256_xor_si256(laneMixAvx2(_mm256_xor_si256(laneMixAvx2(word), keyHigh)), bias);
+            const __m256i pityOn = _mm256_cmpgt_epi32(pity, thresholdMinusOne);
+            __m256i tier = zero;
+            for (int t = 0; t + 1 < m.tierCount; ++t) {
+                const __m256i boundary = _mm256_blendv_epi8(normalB[t], pityB[t], pityOn);
+                // +1, then -1 back where boundary > u
+                tier = _mm256_add_epi32(_mm256_add_epi32(tier, one), _mm256_cmpgt_epi32(boundary, u));
+            }
+            const __m256i rarity = _mm256_permutevar8x32_epi32(rarityTable, tier);
+            const __m256i sell = _mm256_and_si256(active, _mm256_permutevar8x32_epi32(sellTable, rarity));
+
+            const __m256i reset = _mm256_or_si256(pityOn, _mm256_cmpgt_epi32(rarity, resetMinusOne));
+            const __m256i nextPity = _mm256_andnot_si256(reset, _mm256_add_epi32(pity, one));
+            pity = _mm256_blendv_epi8(pity, nextPity, active);
+            currency = _mm256_add_epi32(currency, _mm256_sub_epi32(sell, _mm256_and_si256(active, cost)));
+            earned = _mm256_add_epi32(earned, sell);
+            pulls = _mm256_sub_epi32(pulls, active);
+            pityPulls = _mm256_sub_epi32(pityPulls, _mm256_and_si256(active, pityOn));
+            last = _mm256_blendv_epi8(last, rarity, active);
+
+            const __m256i firstHit = _mm256_and_si256(_mm256_and_si256(active, _mm256_cmpeq_epi32(rarity, top)),
+                                                      _mm256_cmpeq_epi32(firstTop, zero));
+            firstTop = _mm256_blendv_epi8(firstTop, pulls, firstHit);
+            for (int r = 1; r <= MaxRarity; ++r) {
+                const __m256i hit = _mm256_cmpeq_epi32(rarity, _mm256_set1_epi32(r));
+                counts[r] = _mm256_sub_epi32(counts[r], _mm256_and_si256(active, hit));
+            }
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(c.currency + i), currency);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(c.pity + i), pity);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(c.lastRarity + i), last);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(c.firstTop + i), firstTop);
+
+        const uint64_t blockPulls = laneSumAvx2(pulls);
+        stats.pulls += blockPulls;
+        stats.currencySpent += blockPulls * m.pullCost;
+        stats.currencyEarned += laneSumAvx2(earned);
+        stats.pityPulls += laneSumAvx2(pityPulls);
+        for (int r = 1; r <= MaxRarity; ++r) stats.rarityCounts[r] += laneSumAvx2(counts[r]);
+        const __m256i reached = _mm256_cmpgt_epi32(firstTop, zero);
+        stats.sessionsWithTopRarity += laneSumAvx2(_mm256_and_si256(reached, one));
+        stats.pullsToFirstTopRarity += laneSumAvx2(firstTop);
+        stats.sessionsAtPullLimit += laneSumAvx2(_mm256_and_si256(_mm256_cmpgt_epi32(currency, costMinusOne), one));
+    }
+    stats.sessions += c.count;
+}
+
+// The maskz forms with every lane selected keep GCC from warning about the
+// undefined pass-through operand of the unmasked intrinsics.
+static const __mmask16 AllLanes = 0xffff;
+
+__attribute__((target("avx512f")))
+inline __m512i laneMixAvx512(__m512i h) {
+    h = _mm512_xor_si512(h, _mm512_maskz_srli_epi32(AllLanes, h, 16));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0x85ebca6bu)));
+    h = _mm512_xor_si512(h, _mm512_maskz_srli_epi32(AllLanes, h, 13));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32(static_cast<int>(0xc2b2ae35u)));
+    return _mm512_xor_si512(h, _mm512_maskz_srli_epi32(AllLanes, h, 16));
+}
+
+__attribute__((target("avx512f")))
+inline uint64_t laneSumAvx512(__m512i v) {
+    alignas(64) uint32_t lanes[16];
+    _mm512_store_si512(reinterpret_cast<void*>(lanes), v);
+    uint64_t sum = 0;
+    for (int i = 0; i < 16; ++i) sum += lanes[i];
+    return sum;
+}
+
+__attribute__((target("avx512f,popcnt")))
+inline void laneKernelAvx512(const LaneModel& m, LaneChunk& c, SimulationStats& stats) {
+    __m512i normalB[GachaPool::MaxTiers], pityB[GachaPool::MaxTiers];
+    for (size_t t = 0; t < GachaPool::MaxTiers; ++t) {
+        normalB[t] = _mm512_set1_epi32(static_cast<int>(m.normalBoundary[t]));
+        pityB[t] = _mm512_set1_epi32(static_cast<int>(m.pityBoundary[t]));
+    }
+    // Tables padded to 16 entries for the 16-lane permute; indices stay below 8.
+    alignas(64) int32_t rarities[16] = {}, sells[16] = {};
+    for (int t = 0; t < LaneModel::TableSize; ++t) {
+        rarities[t] = m.tierRarity[t];
+        sells[t] = m.sellValue[t];
+    }
+    const __m512i rarityTable = _mm512_load_si512(reinterpret_cast<const void*>(rarities));
+    const __m512i sellTable = _mm512_load_si512(reinterpret_cast<const void*>(sells));
+    const __m512i one = _mm512_set1_epi32(1), resetRarity = _mm512_set1_epi32(PityState::ResetRarity);
+    const __m512i cost = _mm512_set1_epi32(m.pullCost), threshold = _mm512_set1_epi32(m.pityThreshold);
+    const __m512i top = _mm512_set1_epi32(MaxRarity), zero = _mm512_setzero_si512();
+
+    for (size_t i = 0; i < c.count; i += 16) {
+        __m512i currency = _mm512_load_si512(reinterpret_cast<const void*>(c.currency + i));
+        __m512i pity = _mm512_load_si512(reinterpret_cast<const void*>(c.pity + i));
+        __m512i last = _mm512_load_si512(reinterpret_cast<const void*>(c.lastRarity + i));
+        __m512i firstTop = _mm512_load_si512(reinterpret_cast<const void*>(c.firstTop + i));
+        const __m512i keyLow = _mm512_load_si512(reinterpret_cast<const void*>(c.keyLow + i));
+        const __m512i keyHigh = _mm512_load_si512(reinterpret_cast<const void*>(c.keyHigh + i));
+        __m512i pulls = zero, pityPulls = zero, earned = zero;
+        __m512i counts[MaxRarity + 1];
+        for (int r = 0; r <= MaxRarity; ++r) counts[r] = zero;
+
+        for (uint32_t step = 0; step < m.maxSteps; ++step) {
+            const __mmask16 active = _mm512_cmpge_epi32_mask(currency, cost);
+            if (active == 0) break;
+
+            const __m512i word = _mm512_xor_si512(keyLow, _mm512_set1_epi32(static_cast<int>(m.stepWord(step))));
+            const __m512i u = laneMixAvx512(_mm512_xor_si512(laneMixAvx512(word), keyHigh));
+            const __mmask16 pityOn = _mm512_cmpge_epi32_mask(pity, threshold);
+            __m512i tier = zero;
+            for (int t = 0; t + 1 < m.tierCount; ++t) {
+                const __m512i boundary = _mm512_mask_blend_epi32(pityOn, normalB[t], pityB[t]);
+                tier = _mm512_mask_add_epi32(tier, _mm512_cmpge_epu32_mask(u, boundary), tier, one);
+            }
+            const __m512i rarity = _mm512_maskz_permutexvar_epi32(AllLanes, tier, rarityTable);
+            const __m512i sell = _mm512_maskz_permutexvar_epi32(active, rarity, sellTable);
+
+            const __mmask16 reset = pityOn | _mm512_cmpge_epi32_mask(rarity, resetRarity);
+            const __m512i nextPity = _mm512_maskz_add_epi32(static_cast<__mmask16>(~reset), pity, one);
+            pity = _mm512_mask_mov_epi32(pity, active, nextPity);
+            currency = _mm512_mask_sub_epi32(currency, active, _mm512_add_epi32(currency, sell), cost);
+            earned = _mm512_add_epi32(earned, sell);
+            pulls = _mm512_mask_add_epi32(pulls, active, pulls, one);
+            pityPulls = _mm512_mask_add_epi32(pityPulls, active & pityOn, pityPulls, one);
+            last = _mm512_mask_mov_epi32(last, active, rarity);
+
+            const __mmask16 firstHit = active & _mm512_cmpeq_epi32_mask(rarity, top) &
+                                       _mm512_cmpeq_epi32_mask(firstTop, zero);
+            firstTop = _mm512_mask_mov_epi32(firstTop, firstHit, pulls);
+            for (int r = 1; r <= MaxRarity; ++r) {
+                const __mmask16 hit = active & _mm512_cmpeq_epi32_mask(rarity, _mm512_set1_epi32(r));
+                counts[r] = _mm512_mask_add_epi32(counts[r], hit, counts[r], one);
+            }
+        }
+
+        _mm512_store_si512(reinterpret_cast<void*>(c.currency + i), currency);
+        _mm512_store_si512(reinterpret_cast<void*>(c.pity + i), pity);
+        _mm512_store_si512(reinterpret_cast<void*>(c.lastRarity + i), last);
+        _mm512_store_si512(reinterpret_cast<void*>(c.firstTop + i), firstTop);
+
+        const uint64_t blockPulls = laneSumAvx512(pulls);
+        stats.pulls += blockPulls;
+        stats.currencySpent += blockPulls * m.pullCost;
+        stats.currencyEarned += laneSumAvx512(earned);
+        stats.pityPulls += laneSumAvx512(pityPulls);
+        for (int r = 1; r <= MaxRarity; ++r) stats.rarityCounts[r] += laneSumAvx512(counts[r]);
+        stats.sessionsWithTopRarity += _mm_popcnt_u32(_mm512_cmpgt_epi32_mask(firstTop, zero));
+        stats.pullsToFirstTopRarity += laneSumAvx512(firstTop);
+        stats.sessionsAtPullLimit += _mm_popcnt_u32(_mm512_cmpge_epi32_mask(currency, cost));
+    }
+    stats.sessions += c.count;
+}
+#endif
+
+typedef void (*LaneKernelFn)(const LaneModel&, LaneChunk&, SimulationStats&);
+
+inline LaneKernelFn laneKernel() {
+    static const LaneKernelFn kernel = GACHA_WIDEST_KERNEL(laneKernelScalar, laneKernelAvx2, laneKernelAvx512);
+    return kernel;
+}
+
+// Runs config.sessions lane sessions, chunked across threads like Simulation.
+class LaneSimulation {
+public:
+    LaneSimulation(const GachaPool& pool, size_t pityRateState) : pool(&pool), pityRateState(pityRateState) {}
+
+    SimulationResult run(const SimulationConfig& config, LaneKernelFn kernel = laneKernel()) const {
+        const LaneModel model(*pool, pityRateState, config);
+        SimulationResult result;
+        result.threads = workerThreads(config.threads);
+        std::vector<SimulationStats> perWorker(result.threads);
+        std::vector<ChunkBuffer> buffers(result.threads);
+        const Chunk chunk = { &model, kernel, &perWorker, &buffers };
+        result.seconds = runChunked(config.sessions, result.threads, LaneChunk::Lanes, chunk);
+        for (unsigned w = 0; w < result.threads; ++w) result.stats.merge(perWorker[w]);
+        return result;
+    }
+
+private:
+    // Over-aligned, so not plain new under C++11.
+    typedef std::vector<LaneChunk, AlignedAllocator<LaneChunk, 64> > ChunkBuffer;
+
+    struct Chunk {
+        const LaneModel* model;
+        LaneKernelFn kernel;
+        std::vector<SimulationStats>* perWorker;
+        std::vector<ChunkBuffer>* buffers;
+
+        void operator()(unsigned worker, uint64_t first, uint64_t last) const {
+            ChunkBuffer& buffer = (*buffers)[worker];
+            if (buffer.empty()) buffer.resize(1);
+            buffer[0].reset(*model, first, static_cast<size_t>(last - first));
+            SimulationStats local;
+            kernel(*model, buffer[0], local);
+            (*perWorker)[worker].merge(local);
+        }
+    };
+
+    const GachaPool* pool;
+    size_t pityRateState;
+};
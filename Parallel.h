@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Work splitting shared by the simulators. Items (sessions) are claimed in
+// fixed-size chunks from one atomic counter, so fast workers take more chunks
+// and there are no locks. Callers keep per-worker totals indexed by the worker
+// number and merge them after runChunked returns.
+
+// Worker count for a requested thread count; 0 means one per hardware thread.
+inline unsigned workerThreads(unsigned requested) {
+    const unsigned threads = requested ? requested : std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+}
+
+// Calls fn(worker, first, last) for every chunk [first, last) of [0, items),
+// on threads workers (the calling thread is worker 0), and returns the wall
+// time in seconds. Each worker's calls are sequential, so fn may update the
+// worker's own state without synchronisation.
+template <class Fn>
+double runChunked(uint64_t items, unsigned threads, uint64_t chunk, Fn fn) {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<uint64_t> next(0);
+    struct Worker {
+        static void loop(unsigned worker, uint64_t items, uint64_t chunk, std::atomic<uint64_t>& next, Fn& fn) {
+            for (;;) {
+                const uint64_t first = next.fetch_add(chunk, std::memory_order_relaxed);
+                if (first >= items) break;
+                fn(worker, first, items - first < chunk ? items : first + chunk);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads > 0 ? threads - 1 : 0);
+    for (unsigned w = 1; w < threads; ++w) {
+        workers.push_back(std::thread(&Worker::loop, w, items, chunk, std::ref(next), std::ref(fn)));
+    }
+    Worker::loop(0, items, chunk, next, fn);
+    for (size_t w = 0; w < workers.size(); ++w) workers[w].join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
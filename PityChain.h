@@ -0,0 +1,178 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "GachaGame.h"
+
+// Exact answers for the pity rules, treating the PityState counter as a Markov
+// chain on 0..Threshold with rarity odds taken from the pool's tier weights.
+class PityChain {
+public:
+    static const size_t StateCount = PityState::Threshold + 1;
+
+    PityChain(const GachaPool& pool, size_t pityRateState)
+        : normalOdds(MaxRarity + 1, 0.0), pityOdds(MaxRarity + 1, 0.0) {
+        assert(pool.isPrepared());
+        setOdds(pool, 0, normalOdds);
+        setOdds(pool, pityRateState, pityOdds);
+    }
+
+    // Probability of rarity on one pull made from counter state.
+    double rarityProbability(size_t state, int rarity) const {
+        return (pityAt(state).active() ? pityOdds : normalOdds)[rarity];
+    }
+
+    // Long-run share of pulls made from each counter state.
+    std::vector<double> stationary() const {
+        // pi (P - I) = 0 with the last equation replaced by sum(pi) = 1.
+        std::vector<double> a(StateCount * StateCount, 0.0), b(StateCount, 0.0);
+        for (size_t from = 0; from < StateCount; ++from) {
+            for (int r = 0; r <= MaxRarity; ++r) {
+                a[nextState(from, r) * StateCount + from] += rarityProbability(from, r);
+            }
+            a[from * StateCount + from] -= 1.0;
+        }
+        for (size_t s = 0; s < StateCount; ++s) a[(StateCount - 1) * StateCount + s] = 1.0;
+        b[StateCount - 1] = 1.0;
+        solve(a, b);
+        return b;
+    }
+
+    // Long-run share of pulls that come out at rarity.
+    double stationaryRarityRate(int rarity) const {
+        const std::vector<double> pi = stationary();
+        double rate = 0.0;
+        for (size_t s = 0; s < StateCount; ++s) rate += pi[s] * rarityProbability(s, rarity);
+        return rate;
+    }
+
+    // Expected pulls for a fresh player until the first item of rarity (or,
+    // with orHigher, of at least rarity). Infinite if it cannot drop.
+    double expectedPullsTo(int rarity, bool orHigher = false) const {
+        // E[s] = 1 + sum over misses m of P(m | s) * E[next(s, m)]
+        std::vector<double> a(StateCount * StateCount, 0.0), b(StateCount, 1.0);
+        for (size_t s = 0; s < StateCount; ++s) {
+            a[s * StateCount + s] += 1.0;
+            for (int r = 0; r <= MaxRarity; ++r) {
+                if (!hits(r, rarity, orHigher)) a[s * StateCount + nextState(s, r)] -= rarityProbability(s, r);
+            }
+        }
+        if (!solve(a, b)) return HUGE_VAL;
+        return b[0];
+    }
+
+    // out[k] = probability that a fresh player's first hit is pull k, for
+    // k = 1..maxPulls (out[0] is 0). The remaining mass, 1 - sum(out), is the
+    // chance of no hit within maxPulls.
+    std::vector<double> pullsToDistribution(int rarity, size_t maxPulls, bool orHigher = false) const {
+        std::vector<double> out(maxPulls + 1, 0.0);
+        std::vector<double> alive(StateCount, 0.0), next(StateCount);
+        alive[0] = 1.0;
+        for (size_t k = 1; k <= maxPulls; ++k) {
+            for (size_t s = 0; s < StateCount; ++s) next[s] = 0.0;
+            for (size_t s = 0; s < StateCount; ++s) {
+                if (alive[s] == 0.0) continue;
+                for (int r = 0; r <= MaxRarity; ++r) {
+                    const double p = alive[s] * rarityProbability(s, r);
+                    if (hits(r, rarity, orHigher)) out[k] += p;
+                    else next[nextState(s, r)] += p;
+                }
+            }
+            alive.swap(next);
+        }
+        return out;
+    }
+
+    // Expected number of pulls of rarity (or, with orHigher, at least rarity)
+    // among a fresh player's first pulls.
+    double expectedCount(int rarity, size_t pulls, bool orHigher = false) const {
+        std::vector<double> alive(StateCount, 0.0), next(StateCount);
+        alive[0] = 1.0;
+        double count = 0.0;
+        for (size_t k = 0; k < pulls; ++k) {
+            for (size_t s = 0; s < StateCount; ++s) next[s] = 0.0;
+            for (size_t s = 0; s < StateCount; ++s) {
+                for (int r = 0; r <= MaxRarity; ++r) {
+                    const double p = alive[s] * rarityProbability(s, r);
+                    if (hits(r, rarity, orHigher)) count += p;
+                    next[nextState(s, r)] += p;
+                }
+            }
+            alive.swap(next);
+        }
+        return count;
+    }
+
+    void print(std::ostream& out) const {
+        const std::vector<double> pi = stationary();
+        out << "pity counter stationary distribution:";
+        for (size_t s = 0; s < StateCount; ++s) out << " " << pi[s];
+        out << "\n";
+        for (int r = 1; r <= MaxRarity; ++r) {
+            out << "  " << r << "*: rate " << stationaryRarityRate(r)
+                << ", expected pulls to first " << expectedPullsTo(r) << "\n";
+        }
+    }
+
+private:
+    std::vector<double> normalOdds;   // per rarity, below the threshold
+    std::vector<double> pityOdds;     // per rarity, at the threshold
+
+    // PityState::update, as a transition.
+    static size_t nextState(size_t state, int rarity) {
+        PityState pity = pityAt(state);
+        pity.update(rarity);
+        return static_cast<size_t>(pity.counter);
+    }
+
+    static PityState pityAt(size_t state) {
+        PityState pity;
+        pity.counter = static_cast<int>(state);
+        return pity;
+    }
+
+    static bool hits(int rarity, int target, bool orHigher) {
+        return orHigher ? rarity >= target : rarity == target;
+    }
+
+    static void setOdds(const GachaPool& pool, size_t state, std::vector<double>& odds) {
+        const double total = static_cast<double>(pool.getStateTotalWeight(state));
+        if (total == 0) return;
+        for (size_t t = 0; t < pool.getTierCount(); ++t) {
+            const int rarity = pool.getTierRarity(t);
+            if (rarity >= 0 && rarity <= MaxRarity) odds[rarity] += pool.getTierWeight(t, state) / total;
+        }
+    }
+
+    // Solves a x = b in place (b becomes x) by Gaussian elimination with
+    // partial pivoting; false if a is singular.
+    static bool solve(std::vector<double>& a, std::vector<double>& b) {
+        const size_t n = b.size();
+        for (size_t col = 0; col < n; ++col) {
+            size_t pivot = col;
+            for (size_t row = col + 1; row < n; ++row) {
+                if (std::fabs(a[row * n + col]) > std::fabs(a[pivot * n + col])) pivot = row;
+            }
+            if (std::fabs(a[pivot * n + col]) < 1e-300) return false;
+            if (pivot != col) {
+                for (size_t k = 0; k < n; ++k) std::swap(a[col * n + k], a[pivot * n + k]);
+                std::swap(b[col], b[pivot]);
+            }
+            for (size_t row = col + 1; row < n; ++row) {
+                const double f = a[row * n + col] / a[col * n + col];
+                if (f == 0.0) continue;
+                for (size_t k = col; k < n; ++k) a[row * n + k] -= f * a[col * n + k];
+                b[row] -= f * b[col];
+            }
+        }
+        for (size_t col = n; col-- > 0; ) {
+            double x = b[col];
+            for (size_t k = col + 1; k < n; ++k) x -= a[col * n + k] * b[k];
+            b[col] = x / a[col * n + col];
+        }
+        return true;
+    }
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "Arena.h"
+#include "GachaGame.h"
+
+// Many players stored column-wise. A player's dense index changes when another
+// player is removed; the external id is stable. Each player owns a fixed range
+// of stacks in one shared array, recycled on removal.
+class PlayerRegistry {
+public:
+    typedef uint32_t PlayerIndex;
+    static const PlayerIndex NoPlayer = 0xffffffffu;
+
+    PlayerRegistry(const ItemCatalog& catalog, uint16_t stackCapacity = Player::DefaultStackCapacity,
+                   Arena* arena = 0)
+        : catalog(&catalog), stackCapacity(stackCapacity), ids(arena), currency(arena), pity(arena),
+          stackOffset(arena), stackCount(arena), stacks(arena), freeRanges(arena),
+          index(0, IdMap::hasher(), IdMap::key_equal(), IdMap::allocator_type(arena)) {}
+
+    void reserve(size_t players) {
+        ids.reserve(players);
+        currency.reserve(players);
+        pity.reserve(players);
+        stackOffset.reserve(players);
+        stackCount.reserve(players);
+        stacks.reserve(players * stackCapacity);
+        index.reserve(players);
+    }
+
+    // Returns the existing index if externalId is already registered.
+    PlayerIndex add(uint64_t externalId, int startingCurrency = 100) {
+        IdMap::const_iterator it = index.find(externalId);
+        if (it != index.end()) return it->second;
+
+        uint32_t offset;
+        if (!freeRanges.empty()) {
+            offset = freeRanges.back();
+            freeRanges.pop_back();
+        } else {
+            offset = static_cast<uint32_t>(stacks.size());
+            ItemStack empty = { InvalidItem, 0 };
+            stacks.resize(stacks.size() + stackCapacity, empty);
+        }
+
+        const PlayerIndex player = static_cast<PlayerIndex>(ids.size());
+        ids.push_back(externalId);
+        currency.push_back(startingCurrency);
+        pity.push_back(PityState());
+        stackOffset.push_back(offset);
+        stackCount.push_back(0);
+        index[externalId] = player;
+        return player;
+    }
+
+    // The last player takes the removed player's index.
+    bool remove(uint64_t externalId) {
+        IdMap::iterator it = index.find(externalId);
+        if (it == index.end()) return false;
+        const PlayerIndex hole = it->second;
+        index.erase(it);
+        freeRanges.push_back(stackOffset[hole]);
+
+        const PlayerIndex last = static_cast<PlayerIndex>(ids.size() - 1);
+        if (hole != last) {
+            ids[hole] = ids[last];
+            currency[hole] = currency[last];
+            pity[hole] = pity[last];
+            stackOffset[hole] = stackOffset[last];
+            stackCount[hole] = stackCount[last];
+            index[ids[hole]] = hole;
+        }
+        ids.pop_back();
+        currency.pop_back();
+        pity.pop_back();
+        stackOffset.pop_back();
+        stackCount.pop_back();
+        return true;
+    }
+
+    PlayerIndex find(uint64_t externalId) const {
+        IdMap::const_iterator it = index.find(externalId);
+        return it == index.end() ? NoPlayer : it->second;
+    }
+
+    size_t size() const { return ids.size(); }
+    uint64_t getId(PlayerIndex player) const { return ids[player]; }
+    int getCurrency(PlayerIndex player) const { return currency[player]; }
+    const PityState& getPity(PlayerIndex player) const { return pity[player]; }
+    uint16_t getStackCapacity() const { return stackCapacity; }
+
+    // The player's stacks, unordered.
+    const ItemStack* getStacks(PlayerIndex player) const { return &stacks[stackOffset[player]]; }
+    size_t getStackCount(PlayerIndex player) const { return stackCount[player]; }
+
+    // Fails only when the item needs a new stack and the player has none free.
+    bool addItem(PlayerIndex player, ItemId item, uint32_t count = 1) {
+        ItemStack* first = &stacks[stackOffset[player]];
+        const uint16_t n = stackCount[player];
+        for (uint16_t s = 0; s < n; ++s) {
+            if (first[s].item == item) {
+                first[s].count += count;
+                return true;
+            }
+        }
+        if (n >= stackCapacity) return false;
+        first[n].item = item;
+        first[n].count = count;
+        stackCount[player] = n + 1;
+        return true;
+    }
+
+    // Sells up to count copies of item and returns how many were sold; an
+    // emptied stack is replaced by the player's last one.
+    uint32_t sellCopies(PlayerIndex player, ItemId item, uint32_t count) {
+        ItemStack* first = &stacks[stackOffset[player]];
+        for (uint16_t s = 0; s < stackCount[player]; ++s) {
+            if (first[s].item == item) return sellFromStack(player, s, count);
+        }
+        return 0;
+    }
+
+    // Player::sellWhere for one player, with the same filters (e.g.
+    // SellRarityAtMost). Returns the currency earned.
+    template <class Filter>
+    int sellWhere(PlayerIndex player, Filter filter) {
+        const ItemStack* first = &stacks[stackOffset[player]];
+        int earned = 0;
+        // Backwards, so the stack moved into an emptied slot was already seen.
+        for (uint16_t s = stackCount[player]; s-- > 0; ) {
+            const int rarity = catalog->getRarity(first[s].item);
+            const uint32_t count = filter(first[s], rarity);
+            if (count != 0) earned += Player::getSellValue(rarity) * static_cast<int>(sellFromStack(player, s, count));
+        }
+        return earned;
+    }
+
+    // Batched operations across every player.
+
+    void grantAll(int amount) {
+        int32_t* c = currency.data();
+        for (size_t i = 0, n = currency.size(); i < n; ++i) c[i] += amount;
+    }
+
+    int64_t getTotalCurrency() const {
+        int64_t total = 0;
+        for (size_t i = 0; i < currency.size(); ++i) total += currency[i];
+        return total;
+    }
+
+    // One pull per player through GachaGame::drawFor. As in pullGacha, a
+    // player with no free stack or too little currency is refused before
+    // anything is drawn; sell to make room. Returns the pulls made.
+    size_t pullAll(const GachaPool& pool, size_t pityRateState, uint64_t bannerSeed, int cost) {
+        if (pool.empty()) return 0;
+        size_t pulls = 0;
+        for (PlayerIndex player = 0; player < ids.size(); ++player) {
+            if (stackCount[player] >= stackCapacity || currency[player] < cost) continue;
+            addItem(player, GachaGame::drawFor(pool, pityRateState, bannerSeed, *catalog, ids[player], pity[player]));
+            currency[player] -= cost;
+            ++pulls;
+        }
+        return pulls;
+    }
+
+    // sellWhere for every player; returns the total earned.
+    template <class Filter>
+    int64_t sellWhereAll(Filter filter) {
+        int64_t earned = 0;
+        for (PlayerIndex player = 0; player < ids.size(); ++player) earned += sellWhere(player, filter);
+        return earned;
+    }
+
+private:
+    typedef std::unordered_map<uint64_t, PlayerIndex, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                               ArenaAllocator<std::pair<const uint64_t, PlayerIndex> > > IdMap;
+
+    const ItemCatalog* catalog;
+    uint16_t stackCapacity;
+
+    // Hot columns, one entry per dense index.
+    ArenaVector<uint64_t> ids;
+    ArenaVector<int32_t> currency;
+    ArenaVector<PityState> pity;
+    ArenaVector<uint32_t> stackOffset;   // first of the player's stackCapacity slots in stacks
+    ArenaVector<uint16_t> stackCount;
+    static_assert(sizeof(decltype(ids)::value_type) + sizeof(decltype(currency)::value_type) +
+                  sizeof(decltype(pity)::value_type) + sizeof(decltype(stackOffset)::value_type) +
+                  sizeof(decltype(stackCount)::value_type) <= 32, "hot state per player must stay under 32 bytes");
+
+    ArenaVector<ItemStack> stacks;
+    ArenaVector<uint32_t> freeRanges;    // offsets of ranges left by removed players
+    IdMap index;                         // external id -> dense index
+
+    // Sells up to count copies from the player's stack s and credits them.
+    uint32_t sellFromStack(PlayerIndex player, uint16_t s, uint32_t count) {
+        ItemStack* first = &stacks[stackOffset[player]];
+        const uint32_t sold = count < first[s].count ? count : first[s].count;
+        currency[player] += Player::getSellValue(catalog->getRarity(first[s].item)) * static_cast<int32_t>(sold);
+        first[s].count -= sold;
+        if (first[s].count == 0) first[s] = first[--stackCount[player]];
+        return sold;
+    }
+};
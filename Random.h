@@ -0,0 +1,214 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+// Random engines for GachaPool. All of them produce full 64-bit words and model
+// UniformRandomBitGenerator, so they also work with the <random> distributions.
+// The helpers at the bottom turn raw words into draws the same way on every
+// toolchain, which std::uniform_*_distribution does not promise.
+
+// Used to expand one 64-bit seed into engine state.
+class SplitMix64 {
+public:
+    typedef uint64_t result_type;
+
+    explicit SplitMix64(uint64_t seed = 0) : state(seed) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state;
+};
+
+// xoshiro256** by Blackman and Vigna. jump() advances by 2^128 draws and
+// longJump() by 2^192, so one seed can be split into non-overlapping streams.
+class Xoshiro256StarStar {
+public:
+    typedef uint64_t result_type;
+
+    explicit Xoshiro256StarStar(uint64_t seed = 0) { this->seed(seed); }
+
+    // Stream k of a seed is the seeded state jumped k times.
+    Xoshiro256StarStar(uint64_t seed, uint64_t stream) {
+        this->seed(seed);
+        for (uint64_t i = 0; i < stream; ++i) jump();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    void seed(uint64_t value) {
+        SplitMix64 sm(value);
+        for (int i = 0; i < 4; ++i) s[i] = sm();
+    }
+
+    result_type operator()() {
+        const uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    void jump() {
+        static const uint64_t table[4] = {
+            0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+        };
+        applyJump(table);
+    }
+
+    void longJump() {
+        static const uint64_t table[4] = {
+            0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL, 0x77710069854ee241ULL, 0x39109bb02acbe635ULL
+        };
+        applyJump(table);
+    }
+
+private:
+    uint64_t s[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    void applyJump(const uint64_t (&table)[4]) {
+        uint64_t t[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; ++i) {
+            for (int b = 0; b < 64; ++b) {
+                if (table[i] & (1ULL << b)) {
+                    for (int j = 0; j < 4; ++j) t[j] ^= s[j];
+                }
+                (*this)();
+            }
+        }
+        for (int j = 0; j < 4; ++j) s[j] = t[j];
+    }
+};
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+// Output block n is a pure function of (key, counter n), so every stream ID
+// gets its own sequence and seek() jumps anywhere in O(1).
+class Philox4x32 {
+public:
+    typedef uint64_t result_type;
+
+    explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0) : available(0) {
+        key[0] = static_cast<uint32_t>(seed);
+        key[1] = static_cast<uint32_t>(seed >> 32);
+        counter[0] = 0;
+        counter[1] = 0;
+        counter[2] = static_cast<uint32_t>(stream);
+        counter[3] = static_cast<uint32_t>(stream >> 32);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (available == 0) {
+            block(key, counter, buffer);
+            if (++counter[0] == 0) ++counter[1];
+            available = 2;
+        }
+        --available;
+        const uint32_t* words = buffer + (available == 1 ? 0 : 2);
+        return (static_cast<uint64_t>(words[1]) << 32) | words[0];
+    }
+
+    // Moves to the start of output block n (two 64-bit words per block).
+    void seek(uint64_t n) {
+        counter[0] = static_cast<uint32_t>(n);
+        counter[1] = static_cast<uint32_t>(n >> 32);
+        available = 0;
+    }
+
+    static void block(const uint32_t (&k)[2], const uint32_t (&ctr)[4], uint32_t (&out)[4]) {
+        uint32_t x[4] = { ctr[0], ctr[1], ctr[2], ctr[3] };
+        uint32_t k0 = k[0], k1 = k[1];
+        for (int round = 0; round < 10; ++round) {
+            const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * x[0];
+            const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * x[2];
+            const uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x[1] ^ k0;
+            const uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x[3] ^ k1;
+            x[0] = y0;
+            x[1] = static_cast<uint32_t>(p1);
+            x[2] = y2;
+            x[3] = static_cast<uint32_t>(p0);
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        for (int i = 0; i < 4; ++i) out[i] = x[i];
+    }
+
+private:
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t buffer[4];
+    int available;
+};
+
+// Serves another engine's output from a block that is refilled in one tight
+// loop, so batched draws generate their random words up front.
+template <class Engine>
+class RandomBlock {
+public:
+    typedef uint64_t result_type;
+
+    explicit RandomBlock(Engine& engine) : engine(engine), next(Size) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        if (next == Size) {
+            for (size_t i = 0; i < Size; ++i) words[i] = engine();
+            next = 0;
+        }
+        return words[next++];
+    }
+
+private:
+    static const size_t Size = 64;
+
+    Engine& engine;
+    uint64_t words[Size];
+    size_t next;
+};
+
+// Uniform double in [0, 1) from the top 53 bits of one draw.
+template <class Engine>
+inline double uniformUnit(Engine& rng) {
+    static_assert(Engine::max() == std::numeric_limits<uint64_t>::max() && Engine::min() == 0,
+                  "engine must produce full 64-bit words");
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Uniform integer in [0, bound), exact: draws below 2^64 mod bound are rejected.
+template <class Engine>
+inline uint64_t uniformBelow(Engine& rng, uint64_t bound) {
+    static_assert(Engine::max() == std::numeric_limits<uint64_t>::max() && Engine::min() == 0,
+                  "engine must produce full 64-bit words");
+    const uint64_t threshold = (0 - bound) % bound;
+    for (;;) {
+        uint64_t x = rng();
+        if (x >= threshold) return x % bound;
+    }
+}
+
+// Seed for engines that are not given one explicitly.
+inline uint64_t nondeterministicSeed() {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
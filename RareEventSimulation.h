@@ -0,0 +1,237 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "GachaGame.h"
+#include "Parallel.h"
+#include "PityChain.h"
+
+// Importance sampling for rare tiers: tiers of rarity >= targetRarity are
+// drawn boost times as often (capped at MaxProposalRate) and each pull scales
+// the session's weight by p / q. boost 0 aims for about minHits hits per
+// session; boost 1 is plain Monte Carlo. Session k draws from
+// Philox4x32(bannerSeed, k), independent of the thread count.
+
+struct RareEventConfig {
+    uint64_t sessions;
+    unsigned threads;          // 0: one per hardware thread
+    uint64_t bannerSeed;
+    uint32_t pullsPerSession;
+    int targetRarity;          // pulls of at least this rarity are hits
+    uint32_t minHits;          // the tail event is at least minHits hits in a session
+    double boost;              // proposal odds of a hit over the true odds; 0: automatic, 1: plain Monte Carlo
+
+    RareEventConfig()
+        : sessions(100000), threads(0), bannerSeed(1), pullsPerSession(100), targetRarity(MaxRarity), minHits(1),
+          boost(0.0) {}
+};
+
+// Running sums for a weighted mean: the samples are weight * f.
+struct WeightedEstimate {
+    uint64_t count;
+    double sum;
+    double sumSquares;
+
+    WeightedEstimate() : count(0), sum(0.0), sumSquares(0.0) {}
+
+    void add(double value) {
+        count++;
+        sum += value;
+        sumSquares += value * value;
+    }
+
+    void merge(const WeightedEstimate& other) {
+        count += other.count;
+        sum += other.sum;
+        sumSquares += other.sumSquares;
+    }
+
+    double mean() const { return count ? sum / count : 0.0; }
+
+    double standardError() const {
+        if (count < 2) return 0.0;
+        const double m = mean();
+        const double variance = (sumSquares / count - m * m) * count / (count - 1);
+        return variance > 0.0 ? std::sqrt(variance / count) : 0.0;
+    }
+
+    double lower95() const { return mean() - 1.96 * standardError(); }
+    double upper95() const { return mean() + 1.96 * standardError(); }
+};
+
+struct RareEventStats {
+    WeightedEstimate weight;        // the likelihood ratios themselves
+    WeightedEstimate tail;          // P(hits >= minHits)
+    WeightedEstimate hits;          // expected hits per session
+    uint64_t pulls;
+    uint64_t proposalHits;          // hits as drawn, before weighting
+
+    RareEventStats() : pulls(0), proposalHits(0) {}
+
+    void merge(const RareEventStats& other) {
+        weight.merge(other.weight);
+        tail.merge(other.tail);
+        hits.merge(other.hits);
+        pulls += other.pulls;
+        proposalHits += other.proposalHits;
+    }
+
+    double effectiveSampleSize() const {
+        return weight.sumSquares > 0.0 ? weight.sum * weight.sum / weight.sumSquares : 0.0;
+    }
+
+    // Plain Monte Carlo sessions needed for the tail probability's current
+    // standard error, per session actually run.
+    double tailVarianceReduction() const {
+        const double p = tail.mean(), se = tail.standardError();
+        if (se <= 0.0 || tail.count == 0) return 0.0;
+        return p * (1.0 - p) / (se * se * tail.count);
+    }
+};
+
+struct RareEventResult {
+    RareEventConfig config;
+    RareEventStats stats;
+    double trueRate;               // hit probability per pull below the pity threshold
+    double expectedHits;           // exact, per session
+    double boost;                  // as used
+    unsigned threads;
+    double seconds;
+
+    void print(std::ostream& out) const {
+        out << "rarity >= " << config.targetRarity << " over " << config.pullsPerSession << " pulls, "
+            << stats.tail.count << " sessions on " << threads << " threads in " << seconds << " s\n";
+        out << "  per-pull hit rate " << trueRate << ", exact hits/session " << expectedHits << ", boost " << boost
+            << " (" << stats.proposalHits << " proposal hits in " << stats.pulls << " pulls)\n";
+        out << "  P(hits >= " << config.minHits << ") = " << stats.tail.mean() << " +/- " << stats.tail.standardError()
+            << ", 95% CI [" << stats.tail.lower95() << ", " << stats.tail.upper95() << "]\n";
+        out << "  hits/session = " << stats.hits.mean() << " +/- " << stats.hits.standardError()
+            << ", 95% CI [" << stats.hits.lower95() << ", " << stats.hits.upper95() << "]\n";
+        out << "  ESS " << stats.effectiveSampleSize() << ", mean weight " << stats.weight.mean()
+            << ", variance reduction vs plain MC " << stats.tailVarianceReduction() << "x\n";
+    }
+};
+
+class RareEventSimulation {
+public:
+    static const int States = 2;    // below the pity threshold, at it
+
+    RareEventSimulation(const GachaPool& pool, size_t pityRateState)
+        : pool(&pool), pityRateState(pityRateState) {
+        assert(pool.isPrepared() && pool.getTierCount() > 0 && pool.getTierCount() <= GachaPool::MaxTiers);
+    }
+
+    RareEventResult run(const RareEventConfig& config) const {
+        const unsigned threads = workerThreads(config.threads);
+        const Proposal proposal(*pool, pityRateState, config);
+        std::vector<RareEventStats> perWorker(threads);
+        const Chunk chunk = { &proposal, &config, &perWorker };
+
+        RareEventResult result;
+        result.seconds = runChunked(config.sessions, threads, ChunkSessions, chunk);
+        result.config = config;
+        for (unsigned w = 0; w < threads; ++w) result.stats.merge(perWorker[w]);
+        result.trueRate = proposal.trueRate;
+        result.expectedHits = proposal.expectedHits;
+        result.boost = proposal.boost;
+        result.threads = threads;
+        return result;
+    }
+
+private:
+    static const uint64_t ChunkSessions = 256;
+    static constexpr double MaxProposalRate = 0.5;
+
+    // Per rate state: cumulative proposal probabilities and log(p / q) by tier.
+    struct Proposal {
+        double cumulative[States][GachaPool::MaxTiers];
+        double logRatio[States][GachaPool::MaxTiers];
+        bool hit[GachaPool::MaxTiers];
+        int tierRarity[GachaPool::MaxTiers];
+        int tierCount;
+        double trueRate;
+        double expectedHits;
+        double boost;
+
+        Proposal(const GachaPool& pool, size_t pityRateState, const RareEventConfig& config)
+            : tierCount(static_cast<int>(pool.getTierCount())), trueRate(0.0), expectedHits(0.0), boost(1.0) {
+            double p[States][GachaPool::MaxTiers], targetRate[States];
+            const size_t rateStates[States] = { 0, pityRateState };
+            for (int s = 0; s < States; ++s) {
+                const double total = static_cast<double>(pool.getStateTotalWeight(rateStates[s]));
+                targetRate[s] = 0.0;
+                for (int t = 0; t < tierCount; ++t) {
+                    tierRarity[t] = pool.getTierRarity(t);
+                    hit[t] = tierRarity[t] >= config.targetRarity;
+                    p[s][t] = total > 0.0 ? pool.getTierWeight(t, rateStates[s]) / total : 0.0;
+                    if (hit[t]) targetRate[s] += p[s][t];
+                }
+            }
+
+            trueRate = targetRate[0];
+            expectedHits = PityChain(pool, pityRateState).expectedCount(config.targetRarity, config.pullsPerSession, true);
+            boost = config.boost > 0.0 ? config.boost
+                  : expectedHits > 0.0 && expectedHits < config.minHits ? config.minHits / expectedHits : 1.0;
+
+            for (int s = 0; s < States; ++s) {
+                double q = targetRate[s] * boost;
+                if (q > MaxProposalRate) q = MaxProposalRate;
+                if (q < targetRate[s]) q = targetRate[s];
+                const double hitScale = targetRate[s] > 0.0 ? q / targetRate[s] : 1.0;
+                const double missScale = targetRate[s] < 1.0 ? (1.0 - q) / (1.0 - targetRate[s]) : 1.0;
+                double running = 0.0;
+                for (int t = 0; t < tierCount; ++t) {
+                    const double scale = hit[t] ? hitScale : missScale;
+                    running += p[s][t] * scale;
+                    cumulative[s][t] = running;
+                    logRatio[s][t] = scale > 0.0 ? -std::log(scale) : 0.0;
+                }
+                cumulative[s][tierCount - 1] = 2.0;   // rounding never runs past the last tier
+            }
+        }
+
+        int drawTier(int state, double u) const {
+            int t = 0;
+            while (t + 1 < tierCount && u >= cumulative[state][t]) ++t;
+            return t;
+        }
+    };
+
+    struct Chunk {
+        const Proposal* proposal;
+        const RareEventConfig* config;
+        std::vector<RareEventStats>* perWorker;
+
+        void operator()(unsigned worker, uint64_t first, uint64_t last) const {
+            RareEventStats local;
+            for (uint64_t session = first; session < last; ++session) runSession(*proposal, *config, session, local);
+            (*perWorker)[worker].merge(local);
+        }
+    };
+
+    const GachaPool* pool;
+    size_t pityRateState;
+
+    static void runSession(const Proposal& proposal, const RareEventConfig& config, uint64_t session,
+                           RareEventStats& stats) {
+        Philox4x32 rng(config.bannerSeed, session);
+        PityState pity;
+        uint32_t hits = 0;
+        double logWeight = 0.0;
+        for (uint32_t pull = 0; pull < config.pullsPerSession; ++pull) {
+            const int state = pity.active() ? 1 : 0;
+            const int tier = proposal.drawTier(state, uniformUnit(rng));
+            logWeight += proposal.logRatio[state][tier];
+            hits += proposal.hit[tier];
+            pity.update(proposal.tierRarity[tier]);
+        }
+        const double weight = std::exp(logWeight);
+        stats.weight.add(weight);
+        stats.tail.add(hits >= config.minHits ? weight : 0.0);
+        stats.hits.add(weight * hits);
+        stats.pulls += config.pullsPerSession;
+        stats.proposalHits += hits;
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include "CpuDispatch.h"
+
+// Search kernels for GachaPool's prefix-sum mode. A prefix table holds
+// ascending running weights below 2^63 (the AVX2 compare is signed), 64-byte
+// aligned and padded to whole blocks with PrefixPadding.
+
+static const size_t PrefixBlock = 8;                            // 64 bytes of uint64_t
+static const uint64_t PrefixPadding = 0x7fffffffffffffffULL;    // greater than any draw
+
+// Minimal allocator so std::vector can hold SIMD-aligned tables.
+template <class T, size_t Align>
+struct AlignedAllocator {
+    typedef T value_type;
+
+    template <class U>
+    struct rebind { typedef AlignedAllocator<U, Align> other; };
+
+    AlignedAllocator() {}
+    template <class U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        void* raw = std::malloc(n * sizeof(T) + Align + sizeof(void*));
+        if (!raw) throw std::bad_alloc();
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+        uintptr_t aligned = (start + Align - 1) & ~static_cast<uintptr_t>(Align - 1);
+        reinterpret_cast<void**>(aligned)[-1] = raw;
+        return reinterpret_cast<T*>(aligned);
+    }
+
+    void deallocate(T* p, size_t) { if (p) std::free(reinterpret_cast<void**>(p)[-1]); }
+
+    bool operator==(const AlignedAllocator&) const { return true; }
+    bool operator!=(const AlignedAllocator&) const { return false; }
+};
+
+inline size_t countLessEqualScalar(const uint64_t* a, size_t n, uint64_t x) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += a[i] <= x;
+    return count;
+}
+
+#ifdef GACHA_X86_DISPATCH
+__attribute__((target("avx2,popcnt")))
+inline size_t countLessEqualAvx2(const uint64_t* a, size_t n, uint64_t x) {
+    const __m256i key = _mm256_set1_epi64x(static_cast<long long>(x));
+    size_t greater = 0;
+    for (size_t i = 0; i < n; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i gt = _mm256_cmpgt_epi64(v, key);
+        greater += _mm_popcnt_u32(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(gt))));
+    }
+    return n - greater;
+}
+
+__attribute__((target("avx512f,popcnt")))
+inline size_t countLessEqualAvx512(const uint64_t* a, size_t n, uint64_t x) {
+    const __m512i key = _mm512_set1_epi64(static_cast<long long>(x));
+    size_t count = 0;
+    for (size_t i = 0; i < n; i += 8) {
+        __m512i v = _mm512_loadu_si512(reinterpret_cast<const void*>(a + i));
+        count += _mm_popcnt_u32(static_cast<unsigned>(_mm512_cmple_epu64_mask(v, key)));
+    }
+    return count;
+}
+#endif
+
+typedef size_t (*CountLessEqualFn)(const uint64_t*, size_t, uint64_t);
+
+inline CountLessEqualFn countLessEqualKernel() {
+    static const CountLessEqualFn kernel =
+        GACHA_WIDEST_KERNEL(countLessEqualScalar, countLessEqualAvx2, countLessEqualAvx512);
+    return kernel;
+}
+
+// Number of entries <= x among the first n of a padded prefix table.
+// Branchless halving narrows the range to PrefixWindow entries, then the
+// vector kernel counts the block-aligned window that holds the answer.
+inline size_t prefixSearch(const uint64_t* prefix, size_t n, uint64_t x) {
+    static const size_t PrefixWindow = 64;
+
+    const uint64_t* base = prefix;
+    size_t len = n;
+    while (len > PrefixWindow) {
+        const size_t half = len / 2;
+        const bool right = base[half - 1] <= x;   // whole lower half is <= x
+        base += right ? half : 0;
+        len = right ? len - half : half;
+    }
+
+    // Entries between the block boundary and base are all <= x, so starting
+    // the count there only adds what is already known.
+    const size_t skipped = static_cast<size_t>(base - prefix) % PrefixBlock;
+    base -= skipped;
+    len += skipped;
+    len = (len + PrefixBlock - 1) / PrefixBlock * PrefixBlock;
+    return static_cast<size_t>(base - prefix) + countLessEqualKernel()(base, len, x);
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include "Arena.h"
+#include "GachaGame.h"
+#include "Parallel.h"
+
+// Headless Monte Carlo over player sessions. Session k is a fresh Player with
+// id k pulling under pullGacha's rules until broke, salvaging rarity <=
+// salvageRarity when full, or until maxPulls. Results do not depend on threads.
+
+struct SimulationConfig {
+    uint64_t sessions;
+    unsigned threads;          // 0: one per hardware thread
+    uint64_t bannerSeed;
+    int startingCurrency;
+    int pullCost;
+    size_t stackCapacity;
+    int salvageRarity;         // 0: never sell, a full inventory ends the session
+    uint32_t maxPulls;         // per session
+
+    SimulationConfig()
+        : sessions(100000), threads(0), bannerSeed(1), startingCurrency(100), pullCost(GachaGame::getPullCost()),
+          stackCapacity(Player::DefaultStackCapacity), salvageRarity(2), maxPulls(1 << 20) {}
+};
+
+struct SimulationStats {
+    uint64_t sessions;
+    uint64_t pulls;
+    uint64_t pityPulls;                     // pulls made with pity active
+    uint64_t currencySpent;
+    uint64_t currencyEarned;                // from salvage
+    uint64_t rarityCounts[MaxRarity + 1];
+    uint64_t sessionsWithTopRarity;         // sessions that pulled at least one MaxRarity item
+    uint64_t pullsToFirstTopRarity;         // summed over those sessions
+    uint64_t sessionsAtPullLimit;           // stopped by maxPulls rather than running out
+
+    SimulationStats() : sessions(0), pulls(0), pityPulls(0), currencySpent(0), currencyEarned(0),
+                        sessionsWithTopRarity(0), pullsToFirstTopRarity(0), sessionsAtPullLimit(0) {
+        for (int r = 0; r <= MaxRarity; ++r) rarityCounts[r] = 0;
+    }
+
+    void merge(const SimulationStats& other) {
+        sessions += other.sessions;
+        pulls += other.pulls;
+        pityPulls += other.pityPulls;
+        currencySpent += other.currencySpent;
+        currencyEarned += other.currencyEarned;
+        for (int r = 0; r <= MaxRarity; ++r) rarityCounts[r] += other.rarityCounts[r];
+        sessionsWithTopRarity += other.sessionsWithTopRarity;
+        pullsToFirstTopRarity += other.pullsToFirstTopRarity;
+        sessionsAtPullLimit += other.sessionsAtPullLimit;
+    }
+
+    // Every count equal; runs of the same config agree for any thread count.
+    bool operator==(const SimulationStats& other) const {
+        for (int r = 0; r <= MaxRarity; ++r) {
+            if (rarityCounts[r] != other.rarityCounts[r]) return false;
+        }
+        return sessions == other.sessions && pulls == other.pulls && pityPulls == other.pityPulls &&
+               currencySpent == other.currencySpent && currencyEarned == other.currencyEarned &&
+               sessionsWithTopRarity == other.sessionsWithTopRarity &&
+               pullsToFirstTopRarity == other.pullsToFirstTopRarity && sessionsAtPullLimit == other.sessionsAtPullLimit;
+    }
+    bool operator!=(const SimulationStats& other) const { return !(*this == other); }
+
+    double rarityRate(int rarity) const { return pulls ? double(rarityCounts[rarity]) / pulls : 0.0; }
+    double pullsPerSession() const { return sessions ? double(pulls) / sessions : 0.0; }
+};
+
+struct SimulationResult {
+    SimulationStats stats;
+    unsigned threads;
+    double seconds;
+
+    void print(std::ostream& out) const {
+        out << stats.sessions << " sessions, " << stats.pulls << " pulls on " << threads << " threads in "
+            << seconds << " s (" << (seconds > 0 ? stats.pulls / seconds : 0) << " pulls/s)\n";
+        out << "  pulls/session " << stats.pullsPerSession()
+            << ", pity pulls " << (stats.pulls ? double(stats.pityPulls) / stats.pulls : 0.0)
+            << ", salvage income/session " << (stats.sessions ? double(stats.currencyEarned) / stats.sessions : 0.0)
+            << "\n";
+        for (int r = 1; r <= MaxRarity; ++r) out << "  " << r << "*: " << stats.rarityRate(r) << "\n";
+        out << "  sessions reaching " << MaxRarity << "*: " << stats.sessionsWithTopRarity;
+        if (stats.sessionsWithTopRarity) {
+            out << ", mean pulls to first " << double(stats.pullsToFirstTopRarity) / stats.sessionsWithTopRarity;
+        }
+        out << "\n";
+        if (stats.sessionsAtPullLimit) out << "  sessions stopped at the pull limit: " << stats.sessionsAtPullLimit << "\n";
+    }
+};
+
+class Simulation {
+public:
+    Simulation(const GachaPool& pool, const ItemCatalog& catalog, size_t pityRateState)
+        : pool(&pool), catalog(&catalog), pityRateState(pityRateState) {
+        assert(pool.isPrepared());
+    }
+
+    SimulationResult run(const SimulationConfig& config) const {
+        SimulationResult result;
+        result.threads = workerThreads(config.threads);
+        std::vector<SimulationStats> perWorker(result.threads);
+        std::vector<std::unique_ptr<Arena> > arenas(result.threads);
+        const Chunk chunk = { this, &config, &perWorker, &arenas };
+        result.seconds = runChunked(config.sessions, result.threads, ChunkSessions, chunk);
+        for (unsigned w = 0; w < result.threads; ++w) result.stats.merge(perWorker[w]);
+        return result;
+    }
+
+    // One session, as run by the workers.
+    void runSession(const SimulationConfig& config, uint64_t session, Arena& arena, SimulationStats& stats) const {
+        {
+            Player player(*catalog, "", session, config.stackCapacity, &arena);
+            player.reserveInventory();
+            player.earnCurrency(config.startingCurrency - player.getCurrency());
+
+            uint64_t pulls = 0;
+            bool topRarity = false;
+            for (;;) {
+                if (player.inventoryIsFull()) {
+                    if (config.salvageRarity <= 0) break;
+                    stats.currencyEarned += player.sellWhere(SellRarityAtMost(config.salvageRarity));
+                    if (player.inventoryIsFull()) break;
+                }
+                if (!player.canPull(config.pullCost)) break;
+                if (pulls == config.maxPulls) {
+                    stats.sessionsAtPullLimit++;
+                    break;
+                }
+
+                if (player.getPity().active()) stats.pityPulls++;
+                const ItemId item = GachaGame::drawFor(*pool, pityRateState, config.bannerSeed, *catalog,
+                                                       session, player.getPity());
+                player.addItem(item);
+                player.spendCurrency(config.pullCost);
+                ++pulls;
+
+                const int rarity = catalog->getRarity(item);
+                stats.rarityCounts[rarity]++;
+                if (rarity == MaxRarity && !topRarity) {
+                    topRarity = true;
+                    stats.sessionsWithTopRarity++;
+                    stats.pullsToFirstTopRarity += pulls;
+                }
+            }
+            stats.sessions++;
+            stats.pulls += pulls;
+            stats.currencySpent += pulls * config.pullCost;
+        }
+        arena.reset();
+    }
+
+private:
+    static const uint64_t ChunkSessions = 256;
+
+    const GachaPool* pool;
+    const ItemCatalog* catalog;
+    size_t pityRateState;
+
+    struct Chunk {
+        const Simulation* simulation;
+        const SimulationConfig* config;
+        std::vector<SimulationStats>* perWorker;
+        std::vector<std::unique_ptr<Arena> >* arenas;
+
+        void operator()(unsigned worker, uint64_t first, uint64_t last) const {
+            std::unique_ptr<Arena>& arena = (*arenas)[worker];
+            if (!arena) arena.reset(new Arena(64 * 1024));
+            SimulationStats local;
+            for (uint64_t session = first; session < last; ++session) {
+                simulation->runSession(*config, session, *arena, local);
+            }
+            (*perWorker)[worker].merge(local);
+        }
+    };
+};
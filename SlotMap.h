@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Arena.h"
+
+// Handle into a SlotMap. The generation changes every time its slot is
+// reused, so a handle to a removed value never resolves to a newer one.
+struct SlotHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+static const SlotHandle InvalidSlot = { 0xffffffffu, 0 };
+
+// Values live densely packed for iteration; handles reach them through a slot
+// table. Insert and remove are O(1) (removal moves the last value into the
+// gap), and a handle stays valid until its own value is removed. Storage comes
+// from the given Arena, or the heap.
+template <class T>
+class SlotMap {
+public:
+    explicit SlotMap(Arena* arena = 0)
+        : dense(ArenaAllocator<T>(arena)), denseToSlot(ArenaAllocator<uint32_t>(arena)),
+          slots(ArenaAllocator<Slot>(arena)), freeHead(NoSlot) {}
+
+    void reserve(size_t n) {
+        dense.reserve(n);
+        denseToSlot.reserve(n);
+        slots.reserve(n);
+    }
+
+    SlotHandle insert(const T& value) {
+        uint32_t index;
+        if (freeHead != NoSlot) {
+            index = freeHead;
+            freeHead = slots[index].denseIndex;
+        } else {
+            index = static_cast<uint32_t>(slots.size());
+            Slot slot = { 0, 1 };
+            slots.push_back(slot);
+        }
+        slots[index].denseIndex = static_cast<uint32_t>(dense.size());
+        dense.push_back(value);
+        denseToSlot.push_back(index);
+        SlotHandle handle = { index, slots[index].generation };
+        return handle;
+    }
+
+    bool remove(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        Slot& slot = slots[handle.index];
+        const uint32_t hole = slot.denseIndex;
+
+        dense[hole] = dense.back();
+        denseToSlot[hole] = denseToSlot.back();
+        slots[denseToSlot[hole]].denseIndex = hole;
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        slot.generation++;
+        slot.denseIndex = freeHead;   // free slots chain through denseIndex
+        freeHead = handle.index;
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+    }
+
+    T* get(SlotHandle handle) { return contains(handle) ? &dense[slots[handle.index].denseIndex] : 0; }
+    const T* get(SlotHandle handle) const { return contains(handle) ? &dense[slots[handle.index].denseIndex] : 0; }
+
+    // Dense iteration; order changes when values are removed.
+    const ArenaVector<T>& values() const { return dense; }
+    SlotHandle handleAt(size_t denseIndex) const {
+        const uint32_t index = denseToSlot[denseIndex];
+        SlotHandle handle = { index, slots[index].generation };
+        return handle;
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+private:
+    struct Slot {
+        uint32_t denseIndex;
+        uint32_t generation;
+    };
+
+    static const uint32_t NoSlot = 0xffffffffu;
+
+    ArenaVector<T> dense;
+    ArenaVector<uint32_t> denseToSlot;
+    ArenaVector<Slot> slots;
+    uint32_t freeHead;
+};
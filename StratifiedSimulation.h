@@ -0,0 +1,278 @@
+#pragma once
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+#include "GachaGame.h"
+#include "Parallel.h"
+
+// Expected cost to a rarity, with the per-pull uniforms taken from a
+// pseudo-random, Latin hypercube or scrambled Halton point set: session i of a
+// replicate uses point i, pull j its coordinate j. Replicates re-randomize the
+// points, so their spread gives the standard error. Sums are integers, so
+// results do not depend on the thread count.
+
+enum class UniformSource {
+    Pseudo,
+    LatinHypercube,
+    Halton
+};
+
+inline const char* uniformSourceName(UniformSource source) {
+    switch (source) {
+        case UniformSource::LatinHypercube: return "latin hypercube";
+        case UniformSource::Halton: return "scrambled halton";
+        default: return "pseudo-random";
+    }
+}
+
+struct StratifiedConfig {
+    uint64_t sessions;         // per replicate, rounded up to a power of two
+    unsigned replicates;
+    unsigned threads;          // 0: one per hardware thread
+    uint64_t bannerSeed;
+    int targetRarity;          // the first pull of at least this rarity ends the session
+    uint32_t pullCap;
+    int pullCost;
+
+    StratifiedConfig()
+        : sessions(1 << 14), replicates(16), threads(0), bannerSeed(1), targetRarity(MaxRarity), pullCap(100),
+          pullCost(GachaGame::getPullCost()) {}
+};
+
+struct StratifiedResult {
+    UniformSource source;
+    StratifiedConfig config;             // with sessions as rounded
+    std::vector<double> replicateCost;   // mean cost per session, per replicate
+    std::vector<double> replicateHit;    // share of sessions reaching targetRarity, per replicate
+    unsigned threads;
+    double seconds;
+
+    double meanCost() const { return mean(replicateCost); }
+    double costStandardError() const { return standardError(replicateCost); }
+    double hitProbability() const { return mean(replicateHit); }
+    double hitStandardError() const { return standardError(replicateHit); }
+
+    // Variance of the cost estimate against baseline's, at equal sessions.
+    double varianceReduction(const StratifiedResult& baseline) const {
+        const double se = costStandardError(), base = baseline.costStandardError();
+        return se > 0.0 ? base * base / (se * se) : 0.0;
+    }
+
+    // varianceReduction per CPU-second.
+    double efficiencyGain(const StratifiedResult& baseline) const {
+        return seconds > 0.0 ? varianceReduction(baseline) * baseline.seconds / seconds : 0.0;
+    }
+
+    void print(std::ostream& out, const StratifiedResult* baseline = 0) const {
+        out << uniformSourceName(source) << ": " << config.replicates << " x " << config.sessions
+            << " sessions, cap " << config.pullCap << ", on " << threads << " threads in " << seconds << " s\n";
+        out << "  cost to " << config.targetRarity << "* = " << meanCost() << " +/- " << costStandardError()
+            << ", reached " << hitProbability() << " +/- " << hitStandardError() << "\n";
+        if (baseline) {
+            out << "  variance reduction vs " << uniformSourceName(baseline->source) << " " << varianceReduction(*baseline)
+                << "x, per CPU-second " << efficiencyGain(*baseline) << "x\n";
+        }
+    }
+
+private:
+    static double mean(const std::vector<double>& values) {
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i) sum += values[i];
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+
+    static double standardError(const std::vector<double>& values) {
+        if (values.size() < 2) return 0.0;
+        const double m = mean(values);
+        double sum = 0.0;
+        for (size_t i = 0; i < values.size(); ++i) sum += (values[i] - m) * (values[i] - m);
+        return std::sqrt(sum / (values.size() - 1) / values.size());
+    }
+};
+
+// One replicate's randomized point set: coordinate dim of point i.
+class UniformPoints {
+public:
+    static const uint32_t HaltonDimensions = 64;
+
+    UniformPoints(UniformSource source, uint64_t seed, uint64_t points, uint32_t dimensions)
+        : source(source), bits(0) {
+        while ((uint64_t(1) << bits) < points) ++bits;
+        SplitMix64 keys(seed);
+        if (source == UniformSource::LatinHypercube) {
+            permutationKeys.resize(dimensions * PermutationRounds);
+            for (size_t k = 0; k < permutationKeys.size(); ++k) permutationKeys[k] = keys();
+        }
+        if (source == UniformSource::Halton) {
+            const uint32_t count = dimensions < HaltonDimensions ? dimensions : HaltonDimensions;
+            for (uint32_t candidate = 2; primes.size() < count; ++candidate) {
+                bool prime = true;
+                for (size_t p = 0; p < primes.size() && primes[p] * primes[p] <= candidate; ++p) {
+                    if (candidate % primes[p] == 0) prime = false;
+                }
+                if (prime) primes.push_back(candidate);
+            }
+            for (size_t d = 0; d < primes.size(); ++d) {
+                digitOffset.push_back(static_cast<uint32_t>(digits.size()));
+                for (uint32_t i = 0; i < primes[d]; ++i) digits.push_back(static_cast<uint16_t>(i));
+                for (uint32_t i = primes[d] - 1; i > 0; --i) {
+                    std::swap(digits[digitOffset[d] + i], digits[digitOffset[d] + uniformBelow(keys, i + 1)]);
+                }
+            }
+        }
+    }
+
+    // rng is the session's Philox stream; one word is taken per coordinate
+    // whatever the source, so padding coordinates line up across sources.
+    double at(uint64_t point, uint32_t dim, Philox4x32& rng) const {
+        const double jitter = uniformUnit(rng);
+        if (source == UniformSource::LatinHypercube) {
+            return (static_cast<double>(permute(point, dim)) + jitter) / static_cast<double>(uint64_t(1) << bits);
+        }
+        if (source == UniformSource::Halton && dim < primes.size()) return radicalInverse(point, dim);
+        return jitter;
+    }
+
+private:
+    static const int PermutationRounds = 3;
+
+    UniformSource source;
+    int bits;                                // points == 1 << bits
+    std::vector<uint64_t> permutationKeys;   // LatinHypercube: PermutationRounds per coordinate
+    std::vector<uint32_t> primes;            // Halton: base per coordinate
+    std::vector<uint32_t> digitOffset;       // Halton: start of each coordinate's digit permutation
+    std::vector<uint16_t> digits;
+
+    // A keyed bijection on [0, 2^bits): add, odd multiply and xorshift are each
+    // invertible modulo 2^bits.
+    uint64_t permute(uint64_t i, uint32_t dim) const {
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        const uint64_t* key = &permutationKeys[dim * PermutationRounds];
+        for (int round = 0; round < PermutationRounds; ++round) {
+            i = (i + key[round]) & mask;
+            i = (i * (key[round] >> 32 | 1)) & mask;
+            i ^= i >> (bits / 2 + 1);
+        }
+        return i;
+    }
+
+    // Digits of point reversed behind the radix point, each through the
+    // coordinate's permutation; the infinite tail of permuted zero digits is
+    // added in closed form.
+    double radicalInverse(uint64_t point, uint32_t dim) const {
+        const uint32_t base = primes[dim];
+        const uint16_t* perm = &digits[digitOffset[dim]];
+        const double invBase = 1.0 / base;
+        double scale = 1.0, value = 0.0;
+        while (point) {
+            const uint64_t next = point / base;
+            scale *= invBase;
+            value += perm[point - next * base] * scale;
+            point = next;
+        }
+        value += scale * perm[0] / (base - 1);
+        return value < 1.0 ? value : 1.0 - 1.0 / 9007199254740992.0;
+    }
+};
+
+class StratifiedSimulation {
+public:
+    StratifiedSimulation(const GachaPool& pool, size_t pityRateState) : pool(&pool), pityRateState(pityRateState) {
+        assert(pool.isPrepared() && pool.getTierCount() > 0);
+    }
+
+    StratifiedResult run(StratifiedConfig config, UniformSource source) const {
+        uint64_t sessions = 1;
+        while (sessions < config.sessions) sessions <<= 1;
+        config.sessions = sessions;
+        if (config.replicates == 0) config.replicates = 1;
+        const unsigned threads = workerThreads(config.threads);
+
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::vector<UniformPoints> points;
+        points.reserve(config.replicates);
+        for (unsigned r = 0; r < config.replicates; ++r) {
+            points.push_back(UniformPoints(source, replicateSeed(config, r), sessions, config.pullCap));
+        }
+
+        // Items are (replicate, session) pairs, replicate-major.
+        std::vector<std::vector<Totals> > perWorker(threads, std::vector<Totals>(config.replicates));
+        const Chunk chunk = { this, &config, &points, &perWorker };
+        runChunked(sessions * config.replicates, threads, ChunkSessions, chunk);
+
+        StratifiedResult result;
+        result.source = source;
+        result.config = config;
+        for (unsigned r = 0; r < config.replicates; ++r) {
+            Totals totals;
+            for (unsigned w = 0; w < threads; ++w) {
+                totals.pulls += perWorker[w][r].pulls;
+                totals.hits += perWorker[w][r].hits;
+            }
+            result.replicateCost.push_back(static_cast<double>(totals.pulls) * config.pullCost / sessions);
+            result.replicateHit.push_back(static_cast<double>(totals.hits) / sessions);
+        }
+        result.threads = threads;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+private:
+    static const uint64_t ChunkSessions = 256;
+
+    struct Totals {
+        uint64_t pulls;
+        uint64_t hits;
+
+        Totals() : pulls(0), hits(0) {}
+    };
+
+    struct Chunk {
+        const StratifiedSimulation* simulation;
+        const StratifiedConfig* config;
+        const std::vector<UniformPoints>* points;
+        std::vector<std::vector<Totals> >* perWorker;
+
+        void operator()(unsigned worker, uint64_t first, uint64_t last) const {
+            std::vector<Totals>& out = (*perWorker)[worker];
+            for (uint64_t item = first; item < last;) {
+                const unsigned replicate = static_cast<unsigned>(item / config->sessions);
+                const uint64_t replicateEnd = (replicate + 1) * config->sessions;
+                const uint64_t end = replicateEnd < last ? replicateEnd : last;
+                const uint64_t key = replicateSeed(*config, replicate);
+                for (; item < end; ++item) {
+                    simulation->runSession(*config, (*points)[replicate], key, item % config->sessions, out[replicate]);
+                }
+            }
+        }
+    };
+
+    const GachaPool* pool;
+    size_t pityRateState;
+
+    static uint64_t replicateSeed(const StratifiedConfig& config, unsigned replicate) {
+        SplitMix64 seeds(config.bannerSeed ^ (replicate * 0x9e3779b97f4a7c15ULL));
+        return seeds();
+    }
+
+    void runSession(const StratifiedConfig& config, const UniformPoints& points, uint64_t replicateKey,
+                    uint64_t session, Totals& totals) const {
+        Philox4x32 rng(replicateKey, session);
+        PityState pity;
+        for (uint32_t pull = 0; pull < config.pullCap; ++pull) {
+            const size_t tier = pool->tierAt(points.at(session, pull, rng), pity.active() ? pityRateState : 0);
+            const int rarity = pool->getTierRarity(tier);
+            if (rarity >= config.targetRarity) {
+                totals.pulls += pull + 1;
+                totals.hits++;
+                return;
+            }
+            pity.update(rarity);
+        }
+        totals.pulls += config.pullCap;
+    }
+};
@@ -1,5 +1,6 @@
 #define RAYLIB_CLITERAL_SUPPORT
 #include "raylib.h"
+#define GACHA_ALLOCATION_HOOKS_IMPLEMENTATION
 #include "GachaGame.h"
 #include <string>
 
@@ -32,6 +33,7 @@ int main() {
     GachaGame game;
     game.setupPool();
     Player& player = game.getPlayer();
+    const ItemCatalog& catalog = game.getCatalog();
 
     std::string lastMessage = "Press [SPACE] to pull!";
     int lastPulledRarity = 1;
@@ -44,30 +46,38 @@ int main() {
 
         // Game Panel (Left side)
         DrawText("Gacha Game", 20, 20, 32, primaryText);
-        DrawText(TextFormat("Currency: %d", player.getCurrency()), 20, 70, 22, secondaryText);
-        DrawText("Press [SPACE] to Pull", 20, 100, 18, secondaryText);
+        DrawText(TextFormat("Currency: %d    4*: %d  5*: %d  6*: %d", player.getCurrency(),
+                            (int)player.countRarity(4), (int)player.countRarity(5), (int)player.countRarity(6)),
+                 20, 70, 22, secondaryText);
+        DrawText("Press [SPACE] to Pull, [T] to Pull x10, [S] to sell 1-2*", 20, 100, 18, secondaryText);
         DrawText(lastMessage.c_str(), 20, 140, 22, GetRarityColor(lastPulledRarity));
 
         // Inventory Panel (Right side)
         DrawRectangle(screenWidth - inventoryWidth, 0, inventoryWidth, screenHeight, (Color){25, 25, 25, 255});
         DrawText("--- Inventory (click to sell) ---", screenWidth - inventoryWidth + 10, 20, 20, primaryText);
 
-        const auto& inv = player.getInventory();
+        const Inventory& inv = player.getInventory();
+        const ArenaVector<ItemStack>& stacks = inv.getStacks();
+        SlotHandle clicked = InvalidSlot;
         int y = 50;
-        for (size_t i = 0; i < inv.size() && y < screenHeight - 30; ++i, y += 24) {
-            std::string line = inv[i]->getName() + " [" + std::to_string(inv[i]->getRarity()) + "*]";
-            Color rarityColor = GetRarityColor(inv[i]->getRarity());
+        for (size_t i = 0; i < stacks.size() && y < screenHeight - 30; ++i, y += 24) {
+            std::string line = std::string(catalog.getName(stacks[i].item)) + " [" + std::to_string(catalog.getRarity(stacks[i].item)) + "*]";
+            if (stacks[i].count > 1) line += " x" + std::to_string(stacks[i].count);
+            Color rarityColor = GetRarityColor(catalog.getRarity(stacks[i].item));
             int x = screenWidth - inventoryWidth + 10;
 
             DrawText(line.c_str(), x, y, 18, rarityColor);
 
             Rectangle itemBox = {(float)x, (float)y, (float)(inventoryWidth - 20), 20};
             if (CheckCollisionPointRec(GetMousePosition(), itemBox) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                player.sellItem(i + 1);
-                lastMessage = "Sold: " + inv[i]->getName();
-                break;
+                clicked = inv.getStackHandle(i);
             }
         }
+        // Sell after drawing so the stack list is not modified mid-loop.
+        if (const ItemStack* stack = inv.getStack(clicked)) {
+            lastMessage = std::string("Sold: ") + catalog.getName(stack->item);
+            player.sellItem(clicked);
+        }
 
         SetMouseCursor(MOUSE_CURSOR_DEFAULT);
         if (GetMouseX() >= screenWidth - inventoryWidth) SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
@@ -75,13 +85,28 @@ int main() {
 
         // Pull logic
         if (IsKeyPressed(KEY_SPACE)) {
-            auto item = game.pullGacha();
-            if (item) {
-                lastPulledRarity = item->getRarity();
+            ItemId item = game.pullGacha();
+            if (item != InvalidItem) {
+                lastPulledRarity = catalog.getRarity(item);
                 std::string s = "*";
-                lastMessage = "Pulled: " + item->getName() + " [" + (std::to_string(lastPulledRarity) + s*lastPulledRarity) + "️]";
+                lastMessage = std::string("Pulled: ") + catalog.getName(item) + " [" + (std::to_string(lastPulledRarity) + s*lastPulledRarity) + "️]";
+            } else lastMessage = "Cannot pull! Not enough currency or inventory full.";
+        }
+        if (IsKeyPressed(KEY_T)) {
+            auto items = game.pullGachaBatch(10);
+            if (!items.empty()) {
+                lastPulledRarity = 1;
+                for (size_t i = 0; i < items.size(); ++i) {
+                    if (catalog.getRarity(items[i]) > lastPulledRarity) lastPulledRarity = catalog.getRarity(items[i]);
+                }
+                lastMessage = "Pulled " + std::to_string(items.size()) + " items, best [" + std::to_string(lastPulledRarity) + "*]";
             } else lastMessage = "Cannot pull! Not enough currency or inventory full.";
         }
+        if (IsKeyPressed(KEY_S)) {
+            int earned = player.sellWhere(SellRarityAtMost(2));
+            lastPulledRarity = 1;
+            lastMessage = "Salvaged 1-2* items for " + std::to_string(earned) + " currency";
+        }
 
         EndDrawing();
     }
@@ -0,0 +1,22 @@
+// SamplingMode::Alias draws the pool's exact probabilities, and its tables are
+// rebuilt after item edits, including an item whose rate drops to zero.
+#include "SamplingCheck.h"
+
+int main() {
+    DefaultBannerPool banner;
+    GachaPool& pool = banner.pool;
+    checkSampling(pool, SamplingMode::Alias, banner.pity, 100);
+
+    pool.increaseRate(2, 0.3);
+    pool.decreaseRate(8, 100.0);
+    CHECK(pool.getWeight(8) == 0);
+    pool.addItem(banner.catalog.intern("Test Relic", 5), 5, 0.5);
+    checkSampling(pool, SamplingMode::Alias, banner.pity, 200);
+
+    // Draws from the prepared tables only read the pool.
+    const GachaPool& shared = pool;
+    Xoshiro256StarStar a(7), b(7);
+    for (int i = 0; i < 1000; ++i) CHECK(shared.drawIndex(a, 0) == pool.pullIndex(b, 0));
+
+    return checkResult("AliasTest");
+}
@@ -0,0 +1,45 @@
+// The steady-state pull path must not touch the heap. Single and batched pulls
+// run through many pity transitions under one AllocationGuard, which aborts if
+// anything in between reaches operator new; setupPool guards itself.
+#ifndef GACHA_COUNT_ALLOCATIONS
+#define GACHA_COUNT_ALLOCATIONS
+#endif
+#define GACHA_ALLOCATION_HOOKS_IMPLEMENTATION
+#include "Check.h"
+
+int main() {
+    // The hooks are live, so a clean guard means something.
+    const size_t before = allocationCount();
+    delete new int(1);
+    CHECK(allocationCount() == before + 1);
+
+    HeadlessGame game;
+    game.setBannerSeed(12345);
+
+    // A batch needs a free stack per pull, so leave room for one beyond every
+    // catalog item.
+    const int Rounds = 50000, BatchSize = 10;
+    Player& player = game.getPlayer();
+    player.setInventoryCapacity(game.getCatalog().size() + BatchSize);
+    player.earnCurrency(1 << 30);
+
+    std::vector<ItemId> batch;
+    batch.reserve(BatchSize);
+    int pulled = 0, pityTransitions = 0;
+    bool pityWasActive = player.getPity().active();
+    {
+        AllocationGuard guard("pullGacha/pullGachaBatch");
+        for (int round = 0; round < Rounds; ++round) {
+            if (round % 2) pulled += game.pullGachaBatch(BatchSize, batch);
+            else pulled += game.pullGacha() != InvalidItem;
+            if (player.getPity().active() != pityWasActive) {
+                pityWasActive = !pityWasActive;
+                pityTransitions++;
+            }
+        }
+    }
+
+    CHECK(pulled == Rounds / 2 * (BatchSize + 1));
+    CHECK(pityTransitions > 0);
+    return checkResult("AllocationTest");
+}
@@ -0,0 +1,73 @@
+// Arena: size classes and their byte counters, free-list reuse, large
+// allocations, alignment, and reset() keeping blocks for the next run.
+#include "Arena.h"
+#include "Check.h"
+
+int main() {
+    Arena arena;
+    CHECK(arena.getBytesReserved() == 0 && arena.getBytesUsed() == 0);
+
+    // Requests round up to their class: 1 -> 16, 17 -> 32, 100 -> 128.
+    void* a = arena.allocate(1);
+    void* b = arena.allocate(17);
+    void* c = arena.allocate(100);
+    CHECK(arena.getBytesUsed() == 16 + 32 + 128 && arena.getPeakBytesUsed() == 176);
+    CHECK(arena.getBytesReserved() == Arena::DefaultBlockBytes);
+    CHECK(reinterpret_cast<uintptr_t>(a) % Arena::MinClassBytes == 0);
+    CHECK(reinterpret_cast<uintptr_t>(b) % Arena::MinClassBytes == 0);
+    CHECK(reinterpret_cast<uintptr_t>(c) % Arena::MinClassBytes == 0);
+
+    // A freed chunk is the next one handed out in its class, and only there.
+    arena.deallocate(b, 17);
+    CHECK(arena.getBytesUsed() == 144 && arena.getPeakBytesUsed() == 176);
+    CHECK(arena.allocate(64) != b);
+    CHECK(arena.allocate(20) == b);
+    arena.deallocate(a, 1);
+    arena.deallocate(c, 100);
+    void* d = arena.allocate(128);
+    CHECK(d == c && arena.allocate(16) == a);
+
+    // Larger requests are separate allocations, counted while live.
+    const size_t big = Arena::MaxClassBytes + 1;
+    void* large = arena.allocate(big);
+    CHECK(arena.getBytesReserved() == Arena::DefaultBlockBytes + big);
+    const size_t used = arena.getBytesUsed();
+    arena.deallocate(large, big);
+    CHECK(arena.getBytesReserved() == Arena::DefaultBlockBytes && arena.getBytesUsed() == used - big);
+
+    // Filling past one block adds another; reset() keeps both and starts over.
+    std::vector<void*> chunks;
+    for (size_t i = 0; i < Arena::DefaultBlockBytes / Arena::MaxClassBytes + 1; ++i) {
+        chunks.push_back(arena.allocate(Arena::MaxClassBytes));
+    }
+    CHECK(arena.getBytesReserved() == 2 * Arena::DefaultBlockBytes);
+    const size_t peak = arena.getPeakBytesUsed();
+    arena.reset();
+    CHECK(arena.getBytesUsed() == 0 && arena.getPeakBytesUsed() == peak);
+    CHECK(arena.getBytesReserved() == 2 * Arena::DefaultBlockBytes);
+    CHECK(arena.allocate(16) == a);   // the first block's first chunk again
+    for (size_t i = 0; i < chunks.size(); ++i) arena.allocate(Arena::MaxClassBytes);
+    CHECK(arena.getBytesReserved() == 2 * Arena::DefaultBlockBytes);
+
+    // Containers on the arena, and players whose inventories live in it.
+    arena.reset();
+    {
+        ArenaVector<uint64_t> values((ArenaAllocator<uint64_t>(&arena)));
+        for (uint64_t i = 0; i < 10000; ++i) values.push_back(i);
+        CHECK(values[9999] == 9999 && arena.getBytesUsed() >= 10000 * sizeof(uint64_t));
+
+        const HeadlessGame game;
+        std::vector<Player> players;
+        for (int i = 0; i < 100; ++i) players.push_back(Player(game.getCatalog(), "", i, 15, &arena));
+        for (size_t i = 0; i < players.size(); ++i) {
+            players[i].reserveInventory();
+            players[i].addItem(static_cast<ItemId>(i % game.getCatalog().size()));
+        }
+        CHECK(players[42].getInventory().count(42 % game.getCatalog().size()) == 1);
+    }
+    CHECK(arena.getBytesUsed() == 0);
+    arena.release();
+    CHECK(arena.getBytesReserved() == 0);
+
+    return checkResult("ArenaTest");
+}
@@ -0,0 +1,80 @@
+// Compile-time banners: the name order is sorted, a bound catalog finds every
+// item by name, bound and copied pools draw alike, and a pool refuses tiers
+// and rate states past its fixed capacity instead of overflowing.
+#include <cstring>
+#include "SamplingCheck.h"
+
+constexpr BannerItem WideItems[] = {
+    { "One", 1 }, { "Two", 2 }, { "Three", 3 }, { "Four", 4 }, { "Five", 5 }, { "Six", 6 }, { "Seven", 7 }
+};
+constexpr BannerTier WideTiers[] = {
+    { 1, 1000, 0 }, { 2, 1000, 0 }, { 3, 1000, 0 }, { 4, 1000, 0 }, { 5, 1000, 0 }, { 6, 1000, 0 }, { 7, 1000, 0 }
+};
+constexpr BannerWeightTable<7> WideWeights = makeBannerWeights(WideItems, WideTiers);
+constexpr BannerIdTable<7> WideIds = makeBannerIds<7>(MakeBannerIndexList<7>::type());
+constexpr BannerIdTable<7> WideNameOrder = makeBannerNameOrder(WideItems, MakeBannerIndexList<7>::type());
+constexpr Banner WideBanner = { WideItems, WideWeights.values, WideIds.values, WideNameOrder.values, 7, WideTiers, 7 };
+
+int main() {
+    const size_t n = DefaultBanner.itemCount;
+    std::vector<bool> seen(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        CHECK(DefaultBanner.nameOrder[i] < n && !seen[DefaultBanner.nameOrder[i]]);
+        seen[DefaultBanner.nameOrder[i]] = true;
+        if (i > 0) {
+            CHECK(std::strcmp(DefaultBanner.items[DefaultBanner.nameOrder[i - 1]].name,
+                              DefaultBanner.items[DefaultBanner.nameOrder[i]].name) < 0);
+        }
+    }
+    CHECK(std::strcmp(WideItems[WideNameOrder.values[0]].name, "Five") == 0);
+    CHECK(std::strcmp(WideItems[WideNameOrder.values[6]].name, "Two") == 0);
+
+    ItemCatalog catalog;
+    catalog.bindBanner(DefaultBanner);
+    CHECK(catalog.isBoundTo(DefaultBanner) && catalog.size() == n);
+    for (size_t i = 0; i < n; ++i) {
+        CHECK(catalog.find(DefaultBanner.items[i].name) == i);
+        CHECK(catalog.getName(static_cast<ItemId>(i)) == DefaultBanner.items[i].name);
+        CHECK(catalog.getRarity(static_cast<ItemId>(i)) == DefaultBanner.items[i].rarity);
+        CHECK(catalog.intern(DefaultBanner.items[i].name, 1) == i);
+    }
+    CHECK(catalog.find("Aaa") == InvalidItem && catalog.find("Zzz") == InvalidItem);
+    CHECK(catalog.find("Master Swor") == InvalidItem && catalog.find("Master Swords") == InvalidItem);
+    const ItemId relic = catalog.intern("Test Relic", 5);
+    CHECK(relic == n && catalog.find("Test Relic") == relic && catalog.size() == n + 1);
+
+    // Bound pools read the banner in place; copied pools intern and copy it.
+    DefaultBannerPool bound;
+    ItemCatalog unboundCatalog;
+    GachaPool copied;
+    CHECK(copied.loadBanner(DefaultBanner, unboundCatalog) == bound.pity);
+    CHECK(!unboundCatalog.isBoundTo(DefaultBanner) && unboundCatalog.size() == n);
+    for (size_t i = 0; i < n; ++i) {
+        CHECK(bound.pool.getItem(i) == i && copied.getItem(i) == unboundCatalog.find(DefaultBanner.items[i].name));
+        CHECK(bound.pool.getWeight(i) == DefaultBanner.itemWeights[i]);
+        CHECK(copied.getWeight(i) == bound.pool.getWeight(i));
+    }
+    Xoshiro256StarStar a(4), b(4);
+    for (int i = 0; i < 10000; ++i) CHECK(bound.pool.pullIndex(a, bound.pity) == copied.pullIndex(b, bound.pity));
+
+    // Capacity: six rarities fill the tiers, two states are in use.
+    GachaPool& pool = bound.pool;
+    const size_t before = pool.getItemCount();
+    CHECK(pool.addItem(relic, 7, 1.0) == GachaPool::npos);
+    CHECK(pool.getItemCount() == before && pool.getTierCount() == GachaPool::MaxTiers);
+    CHECK(pool.addItem(relic, 5, 1.0) != GachaPool::npos && pool.getItemCount() == before + 1);
+    std::map<int, double> bonus;
+    bonus[6] = 1.0;
+    for (size_t s = pool.getRateStateCount(); s < GachaPool::MaxRateStates; ++s) CHECK(pool.addRateState(bonus) == s);
+    CHECK(pool.addRateState(bonus) == GachaPool::npos && pool.getRateStateCount() == GachaPool::MaxRateStates);
+    checkSampling(pool, SamplingMode::Alias, GachaPool::MaxRateStates - 1, 1100);
+
+    ItemCatalog wideCatalog;
+    wideCatalog.bindBanner(WideBanner);
+    GachaPool wide;
+    CHECK(wide.loadBanner(WideBanner, wideCatalog) == GachaPool::npos);
+    CHECK(wide.empty() && wide.getTierCount() == 0 && wide.getRateStateCount() == 1);
+    CHECK(wideCatalog.find("Seven") == 6 && wideCatalog.find("Eight") == InvalidItem);
+
+    return checkResult("BannerTest");
+}
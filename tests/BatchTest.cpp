@@ -0,0 +1,59 @@
+// Batched pulls: RandomBlock serves its engine's words in order, pool batches
+// equal single pulls, and a game batch equals the same number of pullGacha
+// calls, with the failure cases reported once and nothing for n <= 0.
+#include "Check.h"
+
+int main() {
+    Xoshiro256StarStar engine(3), reference(3);
+    RandomBlock<Xoshiro256StarStar> block(engine);
+    for (int i = 0; i < 1000; ++i) CHECK(block() == reference());
+
+    HeadlessGame source;
+    GachaPool pool = source.getPool();
+    const size_t pity = source.getPityRateState();
+    const SamplingMode modes[] = { SamplingMode::Linear, SamplingMode::Alias, SamplingMode::Fenwick,
+                                   SamplingMode::PrefixSum };
+    for (size_t m = 0; m < 4; ++m) {
+        pool.setSamplingMode(modes[m]);
+        Xoshiro256StarStar batchRng(m), singleRng(m);
+        std::vector<ItemId> batch(1, InvalidItem);
+        pool.pullBatch(1000, batch, batchRng, pity);
+        CHECK(batch.size() == 1001 && batch[0] == InvalidItem);
+        for (size_t i = 1; i < batch.size(); ++i) CHECK(batch[i] == pool.pull(singleRng, pity));
+    }
+    std::vector<ItemId> own;
+    pool.pullBatch(10, own);
+    pool.pullBatch(0, own);
+    CHECK(own.size() == 10);
+
+    // Ten pulls in one batch or one by one: same items, currency and pity.
+    HeadlessGame batched, single;
+    batched.setBannerSeed(11);
+    single.setBannerSeed(11);
+    std::vector<ItemId> pulled;
+    CHECK(batched.pullGachaBatch(10, pulled) == 10);
+    for (size_t i = 0; i < pulled.size(); ++i) CHECK(single.pullGacha() == pulled[i]);
+    CHECK(batched.getPlayer().getCurrency() == single.getPlayer().getCurrency());
+    CHECK(batched.getPullCount() == single.getPullCount());
+    CHECK(batched.getPlayer().getPity().counter == single.getPlayer().getPity().counter);
+
+    std::vector<GameEvent> events;
+    {
+        GachaGame game(std::unique_ptr<EventBackend>(new RecordingBackend(events)));
+        game.pullGachaBatch(5, pulled);   // no setupPool: nothing to pull
+        game.setupPool();
+        game.getPlayer().spendCurrency(55);
+        CHECK(game.pullGachaBatch(0, pulled) == 0 && game.pullGachaBatch(-3, pulled) == 0);
+        CHECK(game.pullGachaBatch(10, pulled) == 4 && pulled.size() == 4);
+        CHECK(game.pullGachaBatch(1, pulled) == 0 && pulled.empty());
+        game.getEvents().flush();
+    }
+    CHECK(events.size() > 0 && events[0].type == GameEventType::PoolEmpty);
+    CHECK(countType(events, GameEventType::PoolEmpty) == 1);
+    CHECK(countType(events, GameEventType::Pulled) == 4);
+    CHECK(countType(events, GameEventType::PartialBatch) == 1);
+    CHECK(countType(events, GameEventType::InsufficientFunds) == 1);
+    CHECK(events.back().type == GameEventType::InsufficientFunds);
+
+    return checkResult("BatchTest");
+}
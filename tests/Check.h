@@ -0,0 +1,68 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include "GachaGame.h"
+
+// Minimal checks for the headless tests: failures are reported and counted,
+// and main returns checkResult().
+
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline bool checkReport(bool ok, const char* what, const char* file, int line) {
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+        checkFailures()++;
+    }
+    return ok;
+}
+
+// |estimate - exact| within sigmas standard errors.
+inline bool checkNear(double estimate, double exact, double standardError, double sigmas, const char* what,
+                      const char* file, int line) {
+    const double tolerance = sigmas * standardError + 1e-12;
+    const bool ok = std::fabs(estimate - exact) <= tolerance;
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: %s: estimate %.9g, exact %.9g, tolerance %.3g\n", file, line, what, estimate,
+                     exact, tolerance);
+        checkFailures()++;
+    }
+    return ok;
+}
+
+inline int checkResult(const char* test) {
+    if (checkFailures()) {
+        std::fprintf(stderr, "%s: %d check(s) failed\n", test, checkFailures());
+        return 1;
+    }
+    std::printf("%s: ok\n", test);
+    return 0;
+}
+
+#define CHECK(cond) checkReport((cond), #cond, __FILE__, __LINE__)
+#define CHECK_NEAR(estimate, exact, standardError, sigmas) \
+    checkNear((estimate), (exact), (standardError), (sigmas), #estimate, __FILE__, __LINE__)
+
+// The game on the default banner, events discarded.
+class HeadlessGame : public GachaGame {
+public:
+    HeadlessGame() : GachaGame(std::unique_ptr<EventBackend>(new NullEventBackend())) { setupPool(); }
+};
+
+// Keeps every drained event; read them after EventSink::flush().
+class RecordingBackend : public EventBackend {
+public:
+    explicit RecordingBackend(std::vector<GameEvent>& out) : out(&out) {}
+    void write(const GameEvent* events, size_t n) { out->insert(out->end(), events, events + n); }
+
+private:
+    std::vector<GameEvent>* out;
+};
+
+inline size_t countType(const std::vector<GameEvent>& events, GameEventType type) {
+    size_t n = 0;
+    for (size_t i = 0; i < events.size(); ++i) n += events[i].type == type;
+    return n;
+}
@@ -0,0 +1,95 @@
+// EventSink: several producers on a small ring lose nothing and keep each
+// producer's order, a dropping sink accounts for every event, flush() returns
+// once everything posted has been written, and a large batch reaches the
+// backend in full.
+#include <cstdio>
+#include <thread>
+#include "Check.h"
+
+static const unsigned Producers = 4;
+static const uint32_t PerProducer = 20000;
+
+struct Producer {
+    EventSink* sink;
+    uint64_t id;
+    void operator()() const {
+        for (uint32_t i = 0; i < PerProducer; ++i) sink->post(makeEvent(GameEventType::Pulled, id, 0, i));
+    }
+};
+
+// Each producer's sequence numbers arrive increasing; returns events received.
+static size_t checkOrder(const std::vector<GameEvent>& events) {
+    std::vector<int64_t> last(Producers, -1);
+    for (size_t i = 0; i < events.size(); ++i) {
+        const GameEvent& e = events[i];
+        if (!CHECK(e.player < Producers && int64_t(e.count) > last[e.player])) break;
+        last[e.player] = e.count;
+    }
+    return events.size();
+}
+
+static void postAll(EventSink& sink) {
+    std::vector<std::thread> threads;
+    for (unsigned p = 0; p < Producers; ++p) {
+        Producer producer = { &sink, p };
+        threads.push_back(std::thread(producer));
+    }
+    for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+    sink.flush();
+}
+
+int main() {
+    const size_t posted = size_t(Producers) * PerProducer;
+    std::vector<GameEvent> events;
+    {
+        EventSink sink(std::unique_ptr<EventBackend>(new RecordingBackend(events)), 256);
+        postAll(sink);
+        CHECK(events.size() == posted && sink.getDroppedCount() == 0);
+    }
+    CHECK(checkOrder(events) == posted);
+
+    events.clear();
+    {
+        EventSink sink(std::unique_ptr<EventBackend>(new RecordingBackend(events)), 256, true);
+        postAll(sink);
+        CHECK(events.size() + sink.getDroppedCount() == posted);
+    }
+    checkOrder(events);
+
+    // A batch far larger than the ring reaches the backend in full.
+    events.clear();
+    {
+        GachaGame game(std::unique_ptr<EventBackend>(new RecordingBackend(events)));
+        game.setupPool();
+        Player& player = game.getPlayer();
+        player.setInventoryCapacity(game.getCatalog().size() + 1);
+        player.earnCurrency(20000 * GachaGame::getPullCost());
+        const size_t n = 3 * EventSink::DefaultCapacity;
+        std::vector<ItemId> pulled;
+        for (size_t done = 0; done < n; ) done += game.pullGachaBatch(static_cast<int>(n - done), pulled);
+        game.getEvents().flush();
+        CHECK(countType(events, GameEventType::Pulled) == n);
+        CHECK(game.getEvents().getDroppedCount() == 0);
+    }
+
+    // Binary records are packed and equal events give equal bytes.
+    const char* path = "EventSinkTest.bin";
+    {
+        EventSink sink(std::unique_ptr<EventBackend>(new BinaryFileEventBackend(path)));
+        for (int i = 0; i < 3; ++i) sink.post(makeEvent(GameEventType::Sold, 9, 4, 2, -7));
+        sink.flush();
+    }
+    std::FILE* file = std::fopen(path, "rb");
+    CHECK(file != 0);
+    if (file) {
+        unsigned char bytes[3 * BinaryFileEventBackend::RecordBytes + 1];
+        const size_t read = std::fread(bytes, 1, sizeof(bytes), file);
+        std::fclose(file);
+        CHECK(read == 3 * BinaryFileEventBackend::RecordBytes && BinaryFileEventBackend::RecordBytes == 21);
+        CHECK(bytes[0] == static_cast<unsigned char>(GameEventType::Sold));
+        CHECK(std::memcmp(bytes, bytes + BinaryFileEventBackend::RecordBytes, BinaryFileEventBackend::RecordBytes) == 0);
+    }
+    std::remove(path);
+
+    return checkResult("EventSinkTest");
+}
@@ -0,0 +1,30 @@
+// SamplingMode::Fenwick draws the exact probabilities, and single-item rate
+// edits on prepared trees give the same draws as trees rebuilt from scratch.
+#include "SamplingCheck.h"
+
+static void edit(GachaPool& pool, int round) {
+    pool.increaseRate(round % 22, 0.25 * (round % 5));
+    pool.decreaseRate((round * 7) % 22, 0.5);
+}
+
+int main() {
+    DefaultBannerPool incremental;
+    checkSampling(incremental.pool, SamplingMode::Fenwick, incremental.pity, 500);
+
+    for (int round = 0; round < 200; ++round) {
+        edit(incremental.pool, round);
+        if (round % 20 != 19) continue;
+
+        // A fresh pool builds its trees from the edited rates on first use.
+        DefaultBannerPool rebuilt;
+        for (int r = 0; r <= round; ++r) edit(rebuilt.pool, r);
+        rebuilt.pool.setSamplingMode(SamplingMode::Fenwick);
+        Xoshiro256StarStar a(round), b(round);
+        for (int i = 0; i < 2000; ++i) {
+            CHECK(incremental.pool.pullIndex(a, incremental.pity) == rebuilt.pool.pullIndex(b, rebuilt.pity));
+        }
+    }
+    checkSampling(incremental.pool, SamplingMode::Fenwick, incremental.pity, 600);
+
+    return checkResult("FenwickTest");
+}
@@ -0,0 +1,55 @@
+// Integer weights: rates round to parts-per-billion, totals are exact sums, and
+// undoing an edit restores the pool bit for bit, draws included.
+#include "SamplingCheck.h"
+
+static GachaPool::Weight sumWeights(const GachaPool& pool) {
+    GachaPool::Weight sum = 0;
+    for (size_t i = 0; i < pool.getItemCount(); ++i) sum += pool.getWeight(i);
+    return sum;
+}
+
+int main() {
+    CHECK(GachaPool::toWeight(1.0) == GachaPool::WeightScale);
+    CHECK(GachaPool::toWeight(0.1) == 100000000);
+    CHECK(GachaPool::toWeight(-0.5) == 0);
+    CHECK(GachaPool::toWeight(0.0000000004) == 0 && GachaPool::toWeight(0.0000000006) == 1);
+
+    DefaultBannerPool banner;
+    GachaPool& pool = banner.pool;
+    CHECK(pool.getTotalWeight() == sumWeights(pool));
+
+    std::vector<GachaPool::Weight> original;
+    for (size_t i = 0; i < pool.getItemCount(); ++i) original.push_back(pool.getWeight(i));
+    const GachaPool::Weight originalTotal = pool.getTotalWeight();
+
+    // 0.1 has no exact double; a thousand round trips still restore the pool.
+    for (int round = 0; round < 1000; ++round) {
+        const size_t item = round % pool.getItemCount();
+        pool.increaseRate(item, 0.1 * (round % 7 + 1));
+        pool.decreaseRate(item, 0.1 * (round % 7 + 1));
+    }
+    for (size_t i = 0; i < pool.getItemCount(); ++i) CHECK(pool.getWeight(i) == original[i]);
+    CHECK(pool.getTotalWeight() == originalTotal && sumWeights(pool) == originalTotal);
+
+    DefaultBannerPool untouched;
+    const SamplingMode modes[] = { SamplingMode::Linear, SamplingMode::Alias, SamplingMode::Fenwick,
+                                   SamplingMode::PrefixSum };
+    for (size_t m = 0; m < 4; ++m) {
+        pool.setSamplingMode(modes[m]);
+        untouched.pool.setSamplingMode(modes[m]);
+        Xoshiro256StarStar a(m), b(m);
+        for (int i = 0; i < 10000; ++i) {
+            CHECK(pool.pullIndex(a, banner.pity) == untouched.pool.pullIndex(b, untouched.pity));
+        }
+    }
+
+    // A decrease past zero removes only what is left.
+    pool.decreaseRate(0, 1000.0);
+    CHECK(pool.getWeight(0) == 0);
+    CHECK(pool.getTotalWeight() == originalTotal - original[0]);
+    pool.increaseRate(0, 0.25);
+    CHECK(pool.getWeight(0) == GachaPool::toWeight(0.25));
+    CHECK(pool.getTotalWeight() == sumWeights(pool));
+
+    return checkResult("FixedPointTest");
+}
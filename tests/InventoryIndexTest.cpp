@@ -0,0 +1,94 @@
+// Inventory indices: per-rarity totals, held items per rarity and the
+// acquisition order match a straightforward model after random adds, sells
+// and re-pulls of sold-out items.
+#include <algorithm>
+#include "Check.h"
+
+struct Model {
+    std::vector<uint32_t> counts;
+    std::vector<ItemId> order;   // held items, first acquisition first
+
+    explicit Model(size_t items) : counts(items, 0) {}
+
+    void add(ItemId item, uint32_t n) {
+        if (counts[item] == 0) order.push_back(item);
+        counts[item] += n;
+    }
+
+    uint32_t remove(ItemId item, uint32_t n) {
+        n = std::min(n, counts[item]);
+        counts[item] -= n;
+        if (n != 0 && counts[item] == 0) order.erase(std::find(order.begin(), order.end(), item));
+        return n;
+    }
+};
+
+static void checkAgainst(const Model& model, const Player& player, const ItemCatalog& catalog) {
+    for (int r = 1; r <= MaxRarity; ++r) {
+        uint64_t total = 0;
+        std::vector<ItemId> held;
+        for (size_t i = 0; i < model.counts.size(); ++i) {
+            if (catalog.getRarity(static_cast<ItemId>(i)) != r) continue;
+            total += model.counts[i];
+            if (model.counts[i]) held.push_back(static_cast<ItemId>(i));
+        }
+        CHECK(player.countRarity(r) == total);
+        const ArenaVector<ItemId>& items = player.getItemsOfRarity(r);
+        std::vector<ItemId> sorted(items.begin(), items.end());
+        std::sort(sorted.begin(), sorted.end());
+        CHECK(sorted == held);
+    }
+    std::vector<ItemId> order;
+    player.getAcquisitionOrder(order);
+    CHECK(order == model.order);
+    for (size_t i = 0; i < model.counts.size(); ++i) {
+        CHECK(player.countItem(catalog.getName(static_cast<ItemId>(i))) == model.counts[i]);
+    }
+}
+
+int main() {
+    HeadlessGame game;
+    const ItemCatalog& catalog = game.getCatalog();
+    Player& player = game.getPlayer();
+    player.setInventoryCapacity(catalog.size());
+    Model model(catalog.size());
+
+    // Hand-checked: selling out Common Sword and pulling it again moves it last.
+    player.addItem(0);
+    player.addItem(12);
+    player.addItem(0);
+    model.add(0, 2);
+    model.add(12, 1);
+    CHECK(player.sellCopies(0, 2) == 2);
+    model.remove(0, 2);
+    player.addItem(0);
+    model.add(0, 1);
+    std::vector<ItemId> order;
+    player.getAcquisitionOrder(order);
+    CHECK(order.size() == 2 && order[0] == 12 && order[1] == 0);
+    checkAgainst(model, player, catalog);
+
+    Xoshiro256StarStar rng(16);
+    for (int step = 0; step < 20000; ++step) {
+        const ItemId item = static_cast<ItemId>(uniformBelow(rng, catalog.size()));
+        const uint32_t n = static_cast<uint32_t>(uniformBelow(rng, 3)) + 1;
+        if (uniformBelow(rng, 2) == 0) {
+            for (uint32_t i = 0; i < n; ++i) player.addItem(item);
+            model.add(item, n);
+        } else {
+            CHECK(player.sellCopies(item, n) == model.remove(item, n));
+        }
+        if (step % 997 == 0) checkAgainst(model, player, catalog);
+        if (step % 5000 == 4999) {
+            player.sellWhere(SellRarityAtMost(2));
+            for (size_t i = 0; i < model.counts.size(); ++i) {
+                if (catalog.getRarity(static_cast<ItemId>(i)) <= 2) model.remove(static_cast<ItemId>(i), model.counts[i]);
+            }
+            checkAgainst(model, player, catalog);
+        }
+    }
+    checkAgainst(model, player, catalog);
+    CHECK(player.countRarity(0) == 0 && player.countRarity(MaxRarity + 1) == 0);
+
+    return checkResult("InventoryIndexTest");
+}
@@ -0,0 +1,48 @@
+// Stacked inventory: copies of an item share one stack, capacity counts
+// stacks, removal is partial or drops the stack, and ids outside the catalog
+// are refused.
+#include "Check.h"
+
+int main() {
+    ItemCatalog catalog;
+    catalog.bindBanner(DefaultBanner);
+    Inventory inventory(catalog, 3);
+    inventory.reserveCatalog();
+
+    CHECK(inventory.add(0) && inventory.add(0, 4) && inventory.add(5));
+    CHECK(inventory.getStackCount() == 2 && inventory.count(0) == 5 && inventory.count(5) == 1);
+    CHECK(inventory.getCopyCount() == 6 && inventory.getFreeStacks() == 1);
+    CHECK(inventory.add(0, 0) && inventory.count(0) == 5);
+
+    CHECK(inventory.add(7) && inventory.isFull());
+    CHECK(!inventory.add(8) && !inventory.contains(8));
+    CHECK(inventory.add(7, 2) && inventory.count(7) == 3);   // existing stacks still grow
+
+    CHECK(!inventory.add(InvalidItem) && !inventory.add(static_cast<ItemId>(catalog.size())));
+    CHECK(inventory.count(InvalidItem) == 0 && inventory.findStack(InvalidItem) == InvalidSlot);
+    CHECK(inventory.remove(InvalidItem) == 0);
+
+    CHECK(inventory.remove(0, 2) == 2 && inventory.count(0) == 3 && inventory.getStackCount() == 3);
+    CHECK(inventory.remove(0, 10) == 3 && !inventory.contains(0) && inventory.getStackCount() == 2);
+    CHECK(inventory.remove(0) == 0 && inventory.getCopyCount() == 4);
+    CHECK(inventory.add(8) && inventory.isFull());
+
+    uint64_t copies = 0;
+    for (size_t i = 0; i < inventory.getStackCount(); ++i) {
+        const ItemStack& stack = inventory.getStacks()[i];
+        CHECK(inventory.getStack(inventory.getStackHandle(i)) == &stack);
+        CHECK(inventory.findStack(stack.item) == inventory.getStackHandle(i));
+        copies += stack.count;
+    }
+    CHECK(copies == inventory.getCopyCount());
+
+    // Raising the capacity makes room for new stacks.
+    inventory.setStackCapacity(5);
+    CHECK(inventory.getStackCapacity() == 5 && inventory.getFreeStacks() == 2 && inventory.add(9));
+
+    // Items interned after reserveCatalog extend the tables on first add.
+    const ItemId relic = catalog.intern("Test Relic", 5);
+    CHECK(inventory.add(relic, 2) && inventory.count(relic) == 2);
+
+    return checkResult("InventoryTest");
+}
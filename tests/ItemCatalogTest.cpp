@@ -0,0 +1,44 @@
+// ItemCatalog: compact ids in interning order, one id per name, and lookups
+// that span a bound banner and the items interned after it.
+#include <cstring>
+#include "Check.h"
+
+int main() {
+    ItemCatalog catalog;
+    CHECK(catalog.size() == 0 && catalog.find("Torch") == InvalidItem);
+    CHECK(catalog.intern("Torch", 2) == 0);
+    CHECK(catalog.intern("Master Sword", 6) == 1);
+    CHECK(catalog.intern("Torch", 5) == 0);   // first rarity wins
+    CHECK(catalog.size() == 2 && !catalog.isBoundTo(DefaultBanner));
+    CHECK(catalog.getRarity(0) == 2 && catalog.getRarity(1) == 6);
+    CHECK(std::strcmp(catalog.getName(1), "Master Sword") == 0);
+    CHECK(catalog.find("Master Sword") == 1 && catalog.find("Master") == InvalidItem);
+
+    char name[32];
+    for (int i = 0; i < 1000; ++i) {
+        std::snprintf(name, sizeof(name), "Item %d", i);
+        CHECK(catalog.intern(name, i % MaxRarity + 1) == static_cast<ItemId>(i + 2));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        std::snprintf(name, sizeof(name), "Item %d", i);
+        const ItemId id = catalog.find(name);
+        CHECK(id == static_cast<ItemId>(i + 2) && std::strcmp(catalog.getName(id), name) == 0);
+        CHECK(catalog.getRarity(id) == i % MaxRarity + 1);
+    }
+
+    // Interned items are numbered after a bound banner's.
+    ItemCatalog bound;
+    bound.bindBanner(DefaultBanner);
+    const ItemId extra = bound.intern("Item 0", 3);
+    CHECK(extra == DefaultBanner.itemCount && bound.size() == DefaultBanner.itemCount + 1);
+    CHECK(bound.find("Item 0") == extra && bound.getRarity(extra) == 3);
+    CHECK(bound.find("Torch") == 7 && std::strcmp(bound.getName(7), "Torch") == 0);
+
+    // Pulls hand out ids; names are read back without copying.
+    HeadlessGame game;
+    const ItemId pulled = game.pullGacha();
+    CHECK(pulled < game.getCatalog().size());
+    CHECK(game.getCatalog().getName(pulled) == DefaultBanner.items[pulled].name);
+
+    return checkResult("ItemCatalogTest");
+}
@@ -0,0 +1,58 @@
+// LaneSimulation: the AVX2 and AVX-512 kernels match the scalar one exactly
+// (partial blocks, salvage on and off, sessions cut off by maxPulls), and
+// results do not depend on the thread count. Kernels the CPU lacks are skipped.
+#include "LaneSimulation.h"
+#include "Check.h"
+
+static SimulationStats compareKernels(const LaneSimulation& lanes, const SimulationConfig& config) {
+    const SimulationStats scalar = lanes.run(config, laneKernelScalar).stats;
+    CHECK(scalar.sessions == config.sessions);
+    CHECK(scalar.pulls > 0);
+#ifdef GACHA_X86_DISPATCH
+    if (cpuKernelLevel() >= KernelLevel::Avx2) CHECK(lanes.run(config, laneKernelAvx2).stats == scalar);
+    else std::printf("no AVX2, laneKernelAvx2 not checked\n");
+    if (cpuKernelLevel() >= KernelLevel::Avx512) CHECK(lanes.run(config, laneKernelAvx512).stats == scalar);
+    else std::printf("no AVX-512, laneKernelAvx512 not checked\n");
+#endif
+    return scalar;
+}
+
+int main() {
+    const HeadlessGame game;
+    const LaneSimulation lanes(game.getPool(), game.getPityRateState());
+
+    SimulationConfig config;
+    config.sessions = 100003;
+    config.threads = 1;
+    config.bannerSeed = 77;
+    compareKernels(lanes, config);
+
+    config.startingCurrency = 1000;
+    config.salvageRarity = 0;
+    compareKernels(lanes, config);
+
+    config.salvageRarity = 1;
+    CHECK(compareKernels(lanes, config).currencyEarned > 0);
+
+    // Selling everything earns more than a pull costs, so only maxPulls stops it.
+    config.sessions = 1000;
+    config.salvageRarity = MaxRarity;
+    config.maxPulls = 5000;
+    const SimulationStats limited = compareKernels(lanes, config);
+    CHECK(limited.sessionsAtPullLimit == config.sessions);
+    CHECK(limited.pulls == uint64_t(config.sessions) * config.maxPulls);
+
+    // 5000 sessions give every thread at least one chunk.
+    SimulationConfig threaded;
+    threaded.sessions = 5000;
+    threaded.bannerSeed = 3;
+    threaded.threads = 1;
+    const SimulationStats single = lanes.run(threaded).stats;
+    const unsigned threadCounts[] = { 2, 3, 8 };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+        threaded.threads = threadCounts[t];
+        CHECK(lanes.run(threaded).stats == single);
+    }
+
+    return checkResult("LaneKernelTest");
+}
@@ -0,0 +1,69 @@
+// PityChain: its queries agree with each other and with the pool's odds, and
+// the exact engine's rarity counts match expectedCount within five standard
+// errors.
+#include <cmath>
+#include "PityChain.h"
+#include "Simulation.h"
+#include "Check.h"
+
+int main() {
+    const HeadlessGame game;
+    const GachaPool& pool = game.getPool();
+    const size_t pity = game.getPityRateState();
+    const PityChain chain(pool, pity);
+
+    // Per-state odds sum to 1, and pity makes ResetRarity or higher likelier.
+    double normal = 0.0, pityTotal = 0.0, normalHigh = 0.0, pityHigh = 0.0;
+    for (int r = 0; r <= MaxRarity; ++r) {
+        normal += chain.rarityProbability(0, r);
+        pityTotal += chain.rarityProbability(PityState::Threshold, r);
+        if (r < PityState::ResetRarity) continue;
+        normalHigh += chain.rarityProbability(0, r);
+        pityHigh += chain.rarityProbability(PityState::Threshold, r);
+    }
+    CHECK(std::fabs(normal - 1.0) < 1e-12 && std::fabs(pityTotal - 1.0) < 1e-12);
+    CHECK(pityHigh > normalHigh);
+
+    // The stationary distribution and rarity rates are distributions, and a
+    // long run of pulls settles at the stationary rates.
+    const std::vector<double> pi = chain.stationary();
+    double piTotal = 0.0, rateTotal = 0.0;
+    for (size_t s = 0; s < PityChain::StateCount; ++s) piTotal += pi[s];
+    for (int r = 0; r <= MaxRarity; ++r) rateTotal += chain.stationaryRarityRate(r);
+    CHECK(std::fabs(piTotal - 1.0) < 1e-12 && std::fabs(rateTotal - 1.0) < 1e-12);
+    const size_t LongRun = 100000;
+    CHECK(std::fabs(chain.expectedCount(3, LongRun) / LongRun - chain.stationaryRarityRate(3)) < 1e-4);
+
+    // The first pull comes from state 0, and expectedPullsTo is the mean of
+    // pullsToDistribution.
+    for (int r = 1; r <= MaxRarity; ++r) {
+        CHECK(std::fabs(chain.expectedCount(r, 1) - chain.rarityProbability(0, r)) < 1e-15);
+        const std::vector<double> first = chain.pullsToDistribution(r, 20000, true);
+        double mean = 0.0, mass = 0.0;
+        for (size_t k = 1; k < first.size(); ++k) {
+            mean += k * first[k];
+            mass += first[k];
+        }
+        CHECK(std::fabs(mass - 1.0) < 1e-9);
+        CHECK_NEAR(mean, chain.expectedPullsTo(r, true), chain.expectedPullsTo(r, true), 1e-6);
+    }
+
+    // Sessions of exactly 200 pulls: no salvage and room for every item, so
+    // only currency ends a session.
+    const uint32_t PullsPerSession = 200;
+    SimulationConfig config;
+    config.sessions = 20000;
+    config.threads = 1;
+    config.startingCurrency = PullsPerSession * GachaGame::getPullCost();
+    config.salvageRarity = 0;
+    config.stackCapacity = game.getCatalog().size() + 1;
+    const SimulationStats stats = Simulation(pool, game.getCatalog(), pity).run(config).stats;
+    CHECK(stats.pulls == stats.sessions * PullsPerSession);
+    for (int r = 1; r <= MaxRarity; ++r) {
+        const double expected = chain.expectedCount(r, PullsPerSession) * stats.sessions;
+        const double p = expected / stats.pulls;
+        CHECK_NEAR(double(stats.rarityCounts[r]), expected, std::sqrt(stats.pulls * p * (1.0 - p)), 5.0);
+    }
+
+    return checkResult("PityChainTest");
+}
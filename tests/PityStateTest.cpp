@@ -0,0 +1,57 @@
+// Per-player pity: the counter rules, and players in different pity states
+// drawing from one shared pool without affecting each other.
+#include "Check.h"
+
+int main() {
+    PityState pity;
+    for (int i = 0; i < PityState::Threshold; ++i) {
+        CHECK(!pity.active());
+        pity.update(1 + i % 2);
+    }
+    CHECK(pity.active() && pity.counter == PityState::Threshold);
+    pity.update(1);   // a pull under active pity resets, whatever came out
+    CHECK(!pity.active() && pity.counter == 0);
+    pity.update(2);
+    pity.update(PityState::ResetRarity);
+    CHECK(pity.counter == 0);
+    pity.update(2);
+    pity.update(MaxRarity);
+    CHECK(pity.counter == 0 && pity.pullCount == 0);
+
+    // Two players on one shared pool: each draw depends only on that player's
+    // own pity and pull number, so interleaving them changes nothing.
+    const HeadlessGame game;
+    const GachaPool& pool = game.getPool();
+    const size_t pityState = game.getPityRateState();
+    PityState a, b, alone;
+    std::vector<ItemId> interleaved, solo;
+    for (int i = 0; i < 2000; ++i) {
+        interleaved.push_back(GachaGame::drawFor(pool, pityState, 5, game.getCatalog(), 1, a));
+        GachaGame::drawFor(pool, pityState, 5, game.getCatalog(), 2, b);
+    }
+    for (int i = 0; i < 2000; ++i) solo.push_back(GachaGame::drawFor(pool, pityState, 5, game.getCatalog(), 1, alone));
+    CHECK(interleaved == solo && a.pullCount == 2000 && b.pullCount == 2000);
+    CHECK(a.counter == alone.counter);
+
+    // The pity state raises the top tiers' odds for the player holding it.
+    uint64_t topBase = 0, topPity = 0;
+    for (uint32_t k = 0; k < 100000; ++k) {
+        topBase += game.getCatalog().getRarity(pool.getItem(pool.derivePullIndex(5, 3, k, 0))) >= 4;
+        topPity += game.getCatalog().getRarity(pool.getItem(pool.derivePullIndex(5, 3, k, pityState))) >= 4;
+    }
+    CHECK(topPity > 2 * topBase);
+
+    // The game player's pity follows the same rules pull by pull.
+    HeadlessGame played;
+    played.setBannerSeed(5);
+    PityState mirror;
+    for (int i = 0; i < 10; ++i) {
+        const ItemId item = played.pullGacha();
+        mirror.update(played.getCatalog().getRarity(item));
+        mirror.pullCount++;
+        CHECK(played.getPlayer().getPity().counter == mirror.counter);
+        CHECK(played.getPullCount() == mirror.pullCount);
+    }
+
+    return checkResult("PityStateTest");
+}
@@ -0,0 +1,77 @@
+// PlayerRegistry: ids map to dense indices through adds and swap-last removes,
+// removed players' stack ranges are recycled, and pullAll and sellWhere match
+// a game player pulling and salvaging on the same banner seed.
+#include "PlayerRegistry.h"
+#include "Check.h"
+
+int main() {
+    const HeadlessGame game;
+    PlayerRegistry registry(game.getCatalog(), 4);
+    for (uint64_t id = 100; id < 110; ++id) CHECK(registry.add(id, 50) == id - 100);
+    CHECK(registry.size() == 10 && registry.add(103) == 3 && registry.size() == 10);
+    CHECK(registry.find(105) == 5 && registry.find(99) == PlayerRegistry::NoPlayer);
+
+    // Give player 102 a stack so its range is recognisable after the move.
+    CHECK(registry.addItem(2, 7, 3) && registry.addItem(2, 7) && registry.getStackCount(2) == 1);
+    const ItemStack* range = registry.getStacks(2);
+    CHECK(range->item == 7 && range->count == 4);
+
+    // Removing 100 moves the last player (109) into index 0.
+    const ItemStack* freed = registry.getStacks(0);
+    CHECK(registry.remove(100) && !registry.remove(100));
+    CHECK(registry.size() == 9 && registry.find(100) == PlayerRegistry::NoPlayer);
+    CHECK(registry.find(109) == 0 && registry.getId(0) == 109 && registry.getCurrency(0) == 50);
+    CHECK(registry.getStacks(registry.find(102)) == range && range->count == 4);
+
+    // A new player takes the freed range instead of growing the array.
+    const PlayerRegistry::PlayerIndex fresh = registry.add(200, 70);
+    CHECK(fresh == 9 && registry.getStacks(fresh) == freed && registry.getStackCount(fresh) == 0);
+    CHECK(registry.getCurrency(fresh) == 70);
+
+    // Stack capacity: a new item needs a free stack, an owned one does not.
+    CHECK(registry.addItem(fresh, 0) && registry.addItem(fresh, 1) && registry.addItem(fresh, 2));
+    CHECK(registry.addItem(fresh, 3) && !registry.addItem(fresh, 4) && registry.addItem(fresh, 3));
+
+    // Selling: copies, then a filter, credited at the per-rarity value.
+    CHECK(registry.sellCopies(fresh, 3, 5) == 2 && registry.getStackCount(fresh) == 3);
+    CHECK(registry.getCurrency(fresh) == 70 + 2 * Player::getSellValue(game.getCatalog().getRarity(3)));
+    CHECK(registry.sellWhere(fresh, SellRarityAtMost(MaxRarity)) == 3 * Player::getSellValue(1));
+    CHECK(registry.getStackCount(fresh) == 0 && registry.sellCopies(fresh, 0, 1) == 0);
+
+    registry.grantAll(10);
+    int64_t total = 0;
+    for (PlayerRegistry::PlayerIndex p = 0; p < registry.size(); ++p) total += registry.getCurrency(p);
+    CHECK(registry.getTotalCurrency() == total);
+
+    // pullAll against a game player with the same id, capacity and salvage.
+    HeadlessGame played;
+    played.setBannerSeed(42);
+    Player& player = played.getPlayer();
+    player.setInventoryCapacity(3);
+    player.earnCurrency(100000 - player.getCurrency());
+    PlayerRegistry mirror(played.getCatalog(), 3);
+    const PlayerRegistry::PlayerIndex p = mirror.add(player.getId(), 100000);
+    size_t registryPulls = 0, gamePulls = 0;
+    for (int i = 0; i < 2000; ++i) {
+        if (mirror.getStackCount(p) >= 3) mirror.sellWhereAll(SellRarityAtMost(MaxRarity));
+        registryPulls += mirror.pullAll(played.getPool(), played.getPityRateState(), 42, GachaGame::getPullCost());
+        if (player.inventoryIsFull()) player.sellWhere(SellRarityAtMost(MaxRarity));
+        gamePulls += played.pullGacha() != InvalidItem;
+    }
+    CHECK(registryPulls == 2000 && gamePulls == 2000);
+    CHECK(mirror.getCurrency(p) == player.getCurrency());
+    CHECK(mirror.getPity(p).pullCount == player.getPity().pullCount);
+    CHECK(mirror.getPity(p).counter == player.getPity().counter);
+    CHECK(mirror.getStackCount(p) == player.getInventory().getStackCount());
+    for (size_t s = 0; s < mirror.getStackCount(p); ++s) {
+        CHECK(player.getInventory().count(mirror.getStacks(p)[s].item) == mirror.getStacks(p)[s].count);
+    }
+
+    // A full player is skipped, not overfilled.
+    PlayerRegistry full(played.getCatalog(), 1);
+    const PlayerRegistry::PlayerIndex f = full.add(1, 1000);
+    for (int i = 0; i < 50; ++i) full.pullAll(played.getPool(), played.getPityRateState(), 1, 10);
+    CHECK(full.getStackCount(f) == 1 && full.getStacks(f)[0].count == full.getPity(f).pullCount);
+
+    return checkResult("PlayerRegistryTest");
+}
@@ -0,0 +1,51 @@
+// prefixSearch and every kernel the CPU supports count the same entries as a
+// scalar scan, on tables with repeated values and at every boundary, and the
+// PrefixSum sampling mode draws the exact probabilities.
+#include "SamplingCheck.h"
+
+static void checkKernel(CountLessEqualFn kernel, const uint64_t* table, size_t padded, uint64_t x) {
+    CHECK(kernel(table, padded, x) == countLessEqualScalar(table, padded, x));
+}
+
+int main() {
+    std::vector<CountLessEqualFn> kernels(1, countLessEqualScalar);
+#ifdef GACHA_X86_DISPATCH
+    if (cpuKernelLevel() >= KernelLevel::Avx2) kernels.push_back(countLessEqualAvx2);
+    if (cpuKernelLevel() >= KernelLevel::Avx512) kernels.push_back(countLessEqualAvx512);
+#endif
+
+    Xoshiro256StarStar rng(8);
+    for (size_t n = 1; n <= 300; n += (n < 20 ? 1 : 7)) {
+        const size_t padded = (n + PrefixBlock - 1) / PrefixBlock * PrefixBlock;
+        std::vector<uint64_t, AlignedAllocator<uint64_t, 64> > table(padded, PrefixPadding);
+        CHECK(reinterpret_cast<uintptr_t>(table.data()) % 64 == 0);
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += uniformBelow(rng, 4) == 0 ? 0 : uniformBelow(rng, uint64_t(1) << 40);
+            table[i] = sum;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const uint64_t boundaries[] = { table[i] - 1, table[i], table[i] + 1 };
+            for (size_t b = 0; b < 3; ++b) {
+                const uint64_t x = boundaries[b];
+                if (x >= sum) continue;   // draws stay below the total
+                CHECK(prefixSearch(table.data(), n, x) == countLessEqualScalar(table.data(), n, x));
+                for (size_t k = 0; k < kernels.size(); ++k) checkKernel(kernels[k], table.data(), padded, x);
+            }
+        }
+        for (int i = 0; i < 200 && sum > 0; ++i) {
+            const uint64_t x = uniformBelow(rng, sum);
+            CHECK(prefixSearch(table.data(), n, x) == countLessEqualScalar(table.data(), n, x));
+            CHECK(countLessEqualKernel()(table.data(), padded, x) == countLessEqualScalar(table.data(), n, x));
+        }
+    }
+
+    DefaultBannerPool banner;
+    checkSampling(banner.pool, SamplingMode::PrefixSum, banner.pity, 900);
+    banner.pool.increaseRate(3, 1.5);
+    banner.pool.addItem(banner.catalog.intern("Test Relic", 5), 5, 0.5);
+    checkSampling(banner.pool, SamplingMode::PrefixSum, banner.pity, 1000);
+
+    return checkResult("PrefixSearchTest");
+}
@@ -0,0 +1,58 @@
+// Random engines: known-answer values, Philox seek and streams, xoshiro jumps,
+// and the range of the draw helpers.
+#include <vector>
+#include "Random.h"
+#include "Check.h"
+
+int main() {
+    // Philox4x32-10 with a zero key and counter (Random123 known-answer test).
+    const uint32_t key[2] = { 0, 0 };
+    const uint32_t counter[4] = { 0, 0, 0, 0 };
+    uint32_t out[4];
+    Philox4x32::block(key, counter, out);
+    CHECK(out[0] == 0x6627e8d5u && out[1] == 0xe169c58du && out[2] == 0xbc57ac4cu && out[3] == 0x9b00dbd8u);
+    Philox4x32 zero;
+    CHECK(zero() == 0xe169c58d6627e8d5ULL);
+    CHECK(zero() == 0x9b00dbd8bc57ac4cULL);
+
+    SplitMix64 splitMix(0);
+    CHECK(splitMix() == 0xe220a8397b1dcdafULL);
+
+    // seek(n) lands where 2n sequential draws would.
+    Philox4x32 sequential(42, 3), seeking(42, 3);
+    std::vector<uint64_t> words;
+    for (int i = 0; i < 200; ++i) words.push_back(sequential());
+    for (uint64_t n = 0; n < 100; n += 7) {
+        seeking.seek(n);
+        CHECK(seeking() == words[2 * n] && seeking() == words[2 * n + 1]);
+    }
+    seeking.seek(uint64_t(1) << 32);
+    Philox4x32 high(42, 3);
+    high.seek(uint64_t(1) << 32);
+    CHECK(seeking() == high());
+
+    // Streams of one seed, and seeds of one stream, give different sequences.
+    Philox4x32 streamA(42, 0), streamB(42, 1), seedB(43, 0);
+    const uint64_t a = streamA();
+    CHECK(a != streamB() && a != seedB());
+
+    Xoshiro256StarStar jumped(42), stream(42, 2), other(42, 1);
+    jumped.jump();
+    jumped.jump();
+    for (int i = 0; i < 100; ++i) CHECK(jumped() == stream());
+    CHECK(other() != stream());
+
+    Xoshiro256StarStar rng(5);
+    bool sawHigh = false;
+    for (int i = 0; i < 100000; ++i) {
+        const double u = uniformUnit(rng);
+        CHECK(u >= 0.0 && u < 1.0);
+        const uint64_t x = uniformBelow(rng, 3);
+        CHECK(x < 3);
+        sawHigh = sawHigh || x == 2;
+    }
+    CHECK(sawHigh);
+    CHECK(uniformBelow(rng, 1) == 0);
+
+    return checkResult("RandomTest");
+}
@@ -0,0 +1,46 @@
+// RareEventSimulation: integer counts do not depend on the thread count, the
+// weighted estimates match the exact PityChain answers within five standard
+// errors, and boost 1 is plain Monte Carlo with every weight 1.
+#include "RareEventSimulation.h"
+#include "Check.h"
+
+int main() {
+    const HeadlessGame game;
+    const GachaPool& pool = game.getPool();
+    const size_t pity = game.getPityRateState();
+    const RareEventSimulation rare(pool, pity);
+    const PityChain chain(pool, pity);
+
+    // 5000 sessions give every thread at least one chunk.
+    RareEventConfig config;
+    config.sessions = 5000;
+    config.minHits = 2;
+    config.threads = 1;
+    const RareEventStats single = rare.run(config).stats;
+    const unsigned threadCounts[] = { 2, 3, 8 };
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+        config.threads = threadCounts[t];
+        const RareEventStats stats = rare.run(config).stats;
+        CHECK(stats.pulls == single.pulls && stats.proposalHits == single.proposalHits);
+        CHECK_NEAR(stats.tail.mean(), single.tail.mean(), single.tail.mean(), 1e-9);
+    }
+
+    config.sessions = 50000;
+    config.threads = 1;
+    config.minHits = 3;
+    const RareEventResult boosted = rare.run(config);
+    const double exactHits = chain.expectedCount(config.targetRarity, config.pullsPerSession, true);
+    CHECK(boosted.boost > 1.0);
+    CHECK(boosted.expectedHits == exactHits);
+    CHECK(boosted.stats.pulls == config.sessions * config.pullsPerSession);
+    CHECK_NEAR(boosted.stats.hits.mean(), exactHits, boosted.stats.hits.standardError(), 5.0);
+    CHECK_NEAR(boosted.stats.weight.mean(), 1.0, boosted.stats.weight.standardError(), 5.0);
+
+    config.boost = 1.0;
+    const RareEventResult plain = rare.run(config);
+    CHECK(plain.stats.weight.mean() == 1.0);
+    CHECK(plain.stats.effectiveSampleSize() == double(config.sessions));
+    CHECK_NEAR(plain.stats.hits.mean(), exactHits, plain.stats.hits.standardError(), 5.0);
+
+    return checkResult("RareEventTest");
+}
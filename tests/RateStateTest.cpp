@@ -0,0 +1,51 @@
+// Rate states: each keeps its own tier weights, item edits reach every state,
+// tier edits only the current one, and draws follow the state asked for.
+#include "SamplingCheck.h"
+
+int main() {
+    DefaultBannerPool banner;
+    GachaPool& pool = banner.pool;
+    CHECK(pool.getRateStateCount() == 2 && banner.pity == 1);
+
+    std::map<int, double> bonus;
+    bonus[6] = 50.0;
+    bonus[7] = 10.0;   // no such tier; ignored
+    const size_t jackpot = pool.addRateState(bonus);
+    CHECK(jackpot == 2 && pool.getRateStateCount() == 3);
+    pool.prepare();
+
+    const size_t top = pool.getTierCount() - 1;
+    const GachaPool::Weight topItems = pool.getTierWeight(top, 0);
+    const GachaPool::Weight commonItems = pool.getTierWeight(0, 0);
+    CHECK(pool.getTierWeight(top, jackpot) == topItems + GachaPool::toWeight(50.0));
+    CHECK(pool.getStateTotalWeight(jackpot) == pool.getStateTotalWeight(0) + GachaPool::toWeight(50.0));
+    checkSampling(pool, SamplingMode::Linear, jackpot, 700);
+
+    // Same engine, different states: only the state changes the odds.
+    Xoshiro256StarStar a(1), b(1);
+    size_t topBase = 0, topJackpot = 0;
+    for (int i = 0; i < 100000; ++i) {
+        topBase += pool.pullIndex(a, 0) == pool.getItemCount() - 1;
+        topJackpot += pool.pullIndex(b, jackpot) == pool.getItemCount() - 1;
+    }
+    CHECK(topBase < 100 && topJackpot > 20000);
+
+    // pull() uses the current state.
+    pool.setRateState(jackpot);
+    CHECK(pool.getRateState() == jackpot);
+    CHECK(pool.getTotalWeight() == pool.getStateTotalWeight(jackpot));
+
+    // A tier edit stays in its state; an item edit reaches all of them.
+    pool.decreaseTierRate(6, 25.0);
+    pool.setRateState(0);
+    pool.increaseRate(0, 2.0);
+    pool.prepare();
+    CHECK(pool.getTierWeight(top, jackpot) == topItems + GachaPool::toWeight(25.0));
+    CHECK(pool.getTierWeight(top, 0) == topItems);
+    for (size_t s = 0; s < pool.getRateStateCount(); ++s) {
+        CHECK(pool.getTierWeight(0, s) == commonItems + GachaPool::toWeight(2.0));
+    }
+    checkSampling(pool, SamplingMode::Alias, jackpot, 800);
+
+    return checkResult("RateStateTest");
+}
@@ -0,0 +1,55 @@
+// Counter-based pulls: every recorded pull, across pity transitions, is
+// recomputed by replayPull in any order, and equal (seed, player, pull number)
+// give equal pulls in another game.
+#include "Check.h"
+
+struct RecordedPull {
+    ItemId item;
+    bool pityWasActive;
+};
+
+int main() {
+    HeadlessGame game;
+    game.setBannerSeed(123);
+    Player& player = game.getPlayer();
+    player.setInventoryCapacity(game.getCatalog().size() + 1);
+    player.earnCurrency(100000);
+
+    std::vector<RecordedPull> pulls;
+    size_t pityPulls = 0, pityStarts = 0;
+    for (int i = 0; i < 5000; ++i) {
+        const bool active = player.getPity().active();
+        RecordedPull pull = { game.pullGacha(), active };
+        CHECK(pull.item != InvalidItem);
+        pityStarts += !active && player.getPity().active();
+        pityPulls += active;
+        pulls.push_back(pull);
+    }
+    CHECK(game.getPullCount() == pulls.size());
+    CHECK(pityStarts > 10 && pityPulls > 10);
+
+    for (size_t k = 0; k < pulls.size(); ++k) {
+        CHECK(game.replayPull(static_cast<uint32_t>(k), pulls[k].pityWasActive) == pulls[k].item);
+    }
+    for (size_t k = pulls.size(); k-- > 0; ) {
+        CHECK(game.replayPull(static_cast<uint32_t>(k), pulls[k].pityWasActive) == pulls[k].item);
+    }
+
+    // The same derivation from a fresh game, and from the shared pool directly.
+    HeadlessGame other;
+    other.setBannerSeed(123);
+    PityState pity;
+    for (size_t k = 0; k < pulls.size(); ++k) {
+        CHECK(other.replayPull(static_cast<uint32_t>(k), pulls[k].pityWasActive) == pulls[k].item);
+        CHECK(GachaGame::drawFor(other.getPool(), other.getPityRateState(), 123, other.getCatalog(), player.getId(),
+                                 pity) == pulls[k].item);
+    }
+    CHECK(pity.pullCount == pulls.size());
+
+    other.setBannerSeed(124);
+    size_t same = 0;
+    for (size_t k = 0; k < pulls.size(); ++k) same += other.replayPull(static_cast<uint32_t>(k), false) == pulls[k].item;
+    CHECK(same < pulls.size() / 2);
+
+    return checkResult("ReplayTest");
+}
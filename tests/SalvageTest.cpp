@@ -0,0 +1,66 @@
+// Bulk sell: each filter sells the copies it selects from every stack, the
+// total is credited once, and a single Salvaged event reports it.
+#include "Check.h"
+
+static int sellValueOf(const ItemCatalog& catalog, const Inventory& inventory) {
+    int value = 0;
+    for (size_t i = 0; i < inventory.getStackCount(); ++i) {
+        const ItemStack& stack = inventory.getStacks()[i];
+        value += Player::getSellValue(catalog.getRarity(stack.item)) * static_cast<int>(stack.count);
+    }
+    return value;
+}
+
+int main() {
+    ItemCatalog catalog;
+    catalog.bindBanner(DefaultBanner);
+    std::vector<GameEvent> events;
+    EventSink sink(std::unique_ptr<EventBackend>(new RecordingBackend(events)));
+    {
+        Player player(catalog, "Salvager", 7, catalog.size());
+        player.reserveInventory();
+        player.setEventSink(&sink);
+        const ItemId items[] = { 0, 0, 0, 7, 12, 12, 12, 12, 21, 21 };   // rarities 1, 2, 3, 6
+        for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); ++i) player.addItem(items[i]);
+        const int start = player.getCurrency();
+
+        // Keep one of each: 2 x 5 + 3 x 20 + 1 x 150.
+        CHECK(player.sellWhere(SellDuplicatesBeyond(1)) == 220);
+        CHECK(player.getCurrency() == start + 220);
+        CHECK(player.countItem("Common Sword") == 1 && player.countItem("Torch") == 1);
+        CHECK(player.countItem("Rare Spear") == 1 && player.countItem("Master Sword") == 1);
+
+        // Everything of rarity 2 or lower: 5 + 10, and those stacks are gone.
+        CHECK(player.sellWhere(SellRarityAtMost(2)) == 15);
+        CHECK(player.getCurrency() == start + 235);
+        CHECK(!player.owns("Common Sword") && !player.owns("Torch") && player.getInventory().getStackCount() == 2);
+
+        CHECK(player.sellWhere(SellRarityAtMost(2)) == 0 && player.getCurrency() == start + 235);
+
+        // A larger random inventory: the credit equals the value of what left.
+        Xoshiro256StarStar rng(15);
+        for (int i = 0; i < 2000; ++i) player.addItem(static_cast<ItemId>(uniformBelow(rng, catalog.size())));
+        const int before = player.getCurrency(), held = sellValueOf(catalog, player.getInventory());
+        const int earned = player.sellWhere(SellDuplicatesBeyond(3));
+        CHECK(player.getCurrency() == before + earned);
+        CHECK(sellValueOf(catalog, player.getInventory()) == held - earned);
+        for (size_t i = 0; i < player.getInventory().getStackCount(); ++i) {
+            CHECK(player.getInventory().getStacks()[i].count <= 3);
+        }
+        CHECK(player.sellWhere(SellRarityAtMost(MaxRarity)) == held - earned);
+        CHECK(player.getInventory().getStackCount() == 0 && player.getInventory().getCopyCount() == 0);
+        sink.flush();
+    }
+
+    // One Salvaged event per call, none per item.
+    CHECK(countType(events, GameEventType::Salvaged) == 5 && countType(events, GameEventType::Sold) == 0);
+    std::vector<GameEvent> salvaged;
+    for (size_t i = 0; i < events.size(); ++i) {
+        if (events[i].type == GameEventType::Salvaged) salvaged.push_back(events[i]);
+    }
+    CHECK(salvaged[0].count == 6 && salvaged[0].value == 220 && salvaged[0].player == 7);
+    CHECK(salvaged[1].count == 2 && salvaged[1].value == 15);
+    CHECK(salvaged[2].count == 0 && salvaged[2].value == 0);
+
+    return checkResult("SalvageTest");
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Check.h"
+
+// Chi-square of draws from one rate state against the pool's exact item
+// probabilities: tier weight over the state total, times the item's share of
+// its tier. Items with no chance must never come out.
+inline double samplingChiSquare(GachaPool& pool, size_t state, uint64_t seed, size_t draws) {
+    Xoshiro256StarStar rng(seed);
+    const size_t n = pool.getItemCount();
+    std::vector<uint64_t> counts(n, 0);
+    for (size_t i = 0; i < draws; ++i) counts[pool.pullIndex(rng, state)]++;
+
+    double statistic = 0.0;
+    size_t first = 0;
+    for (size_t t = 0; t < pool.getTierCount(); ++t) {
+        const size_t size = pool.getTierSize(pool.getTierRarity(t));
+        GachaPool::Weight itemTotal = 0;
+        for (size_t i = first; i < first + size; ++i) itemTotal += pool.getWeight(i);
+        const double tierShare = double(pool.getTierWeight(t, state)) / pool.getStateTotalWeight(state);
+        for (size_t i = first; i < first + size; ++i) {
+            const double p = tierShare * (itemTotal ? double(pool.getWeight(i)) / itemTotal : 1.0 / size);
+            const double expected = p * draws;
+            if (expected > 0.0) statistic += (counts[i] - expected) * (counts[i] - expected) / expected;
+            else CHECK(counts[i] == 0);
+        }
+        first += size;
+    }
+    return statistic;
+}
+
+// Checks mode against the exact probabilities in rate states 0 and pity. The
+// default banner has 21 degrees of freedom, whose 1e-6 tail starts near 58, so
+// 80 only trips on real bias.
+inline void checkSampling(GachaPool& pool, SamplingMode mode, size_t pity, uint64_t seed) {
+    pool.setSamplingMode(mode);
+    pool.prepare();
+    const size_t states[] = { 0, pity };
+    for (size_t s = 0; s < 2; ++s) {
+        const double statistic = samplingChiSquare(pool, states[s], seed + s, 1000000);
+        if (!CHECK(statistic < 80.0)) {
+            std::fprintf(stderr, "  mode %d state %zu: chi-square %.1f\n", static_cast<int>(mode), states[s], statistic);
+        }
+    }
+}
+
+// A pool on the default banner, reading its tables in place.
+struct DefaultBannerPool {
+    ItemCatalog catalog;
+    GachaPool pool;
+    size_t pity;
+
+    DefaultBannerPool() {
+        catalog.bindBanner(DefaultBanner);
+        pity = pool.loadBanner(DefaultBanner, catalog);
+    }
+};
@@ -0,0 +1,51 @@
+// Simulation: results do not depend on the thread count, session k is the
+// game's own player with id k, and maxPulls ends sessions that salvage keeps
+// funding.
+#include "Simulation.h"
+#include "Check.h"
+
+int main() {
+    const HeadlessGame game;
+    const Simulation simulation(game.getPool(), game.getCatalog(), game.getPityRateState());
+
+    // 1000 sessions leave some threads without a chunk; 5000 do not.
+    SimulationConfig config;
+    config.bannerSeed = 9;
+    const uint64_t sessionCounts[] = { 1000, 5000 };
+    const unsigned threadCounts[] = { 1, 2, 3, 8 };
+    for (size_t s = 0; s < 2; ++s) {
+        config.sessions = sessionCounts[s];
+        config.threads = 1;
+        const SimulationStats single = simulation.run(config).stats;
+        CHECK(single.sessions == config.sessions && single.pulls > 0);
+        for (size_t t = 1; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+            config.threads = threadCounts[t];
+            CHECK(simulation.run(config).stats == single);
+        }
+    }
+
+    // Session 0 pulls exactly what a fresh game with player id 0 pulls.
+    HeadlessGame player;
+    player.setBannerSeed(9);
+    uint64_t pulls = 0, top = 0;
+    for (ItemId item; (item = player.pullGacha()) != InvalidItem; ++pulls) top += player.getCatalog().getRarity(item) == MaxRarity;
+    SimulationConfig one;
+    one.sessions = 1;
+    one.threads = 1;
+    one.bannerSeed = 9;
+    one.salvageRarity = 0;
+    const SimulationStats first = simulation.run(one).stats;
+    CHECK(first.pulls == pulls && first.rarityCounts[MaxRarity] == top);
+
+    // Selling everything pays for the next pull, so only maxPulls stops these.
+    config.sessions = 50;
+    config.threads = 1;
+    config.startingCurrency = 1000;
+    config.salvageRarity = MaxRarity;
+    config.maxPulls = 2000;
+    const SimulationStats limited = simulation.run(config).stats;
+    CHECK(limited.sessionsAtPullLimit == config.sessions);
+    CHECK(limited.pulls == config.sessions * config.maxPulls);
+
+    return checkResult("SimulationTest");
+}
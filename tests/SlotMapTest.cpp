@@ -0,0 +1,77 @@
+// SlotMap handles go stale exactly when their own value is removed: removal
+// of others (which moves values in the dense array) leaves them valid, and a
+// reused slot never answers to a handle from before the reuse.
+#include <map>
+#include "SlotMap.h"
+#include "Check.h"
+
+int main() {
+    SlotMap<int> map;
+    CHECK(!map.contains(InvalidSlot) && map.get(InvalidSlot) == 0);
+
+    const SlotHandle a = map.insert(1), b = map.insert(2), c = map.insert(3);
+    CHECK(map.size() == 3 && *map.get(a) == 1 && *map.get(b) == 2 && *map.get(c) == 3);
+
+    // Removing a moves c into its dense position; c's handle still finds it.
+    CHECK(map.remove(a));
+    CHECK(!map.contains(a) && map.get(a) == 0);
+    CHECK(map.get(c) != 0 && *map.get(c) == 3 && *map.get(b) == 2);
+    CHECK(!map.remove(a));
+
+    // The freed slot is reused under a new generation.
+    const SlotHandle d = map.insert(4);
+    CHECK(d.index == a.index && d != a);
+    CHECK(map.get(a) == 0 && *map.get(d) == 4);
+
+    // Many reuses of one slot: every earlier handle stays stale.
+    std::vector<SlotHandle> old;
+    SlotHandle current = d;
+    for (int i = 0; i < 1000; ++i) {
+        old.push_back(current);
+        CHECK(map.remove(current));
+        current = map.insert(100 + i);
+        CHECK(current.index == d.index);
+    }
+    for (size_t i = 0; i < old.size(); ++i) CHECK(!map.contains(old[i]));
+    CHECK(*map.get(current) == 1099 && map.size() == 3);
+
+    CHECK(map.remove(b) && map.remove(c) && map.remove(current));
+    CHECK(map.empty() && map.get(b) == 0 && map.get(c) == 0 && map.get(current) == 0);
+
+    // Random inserts and removes against a reference: values stay dense and
+    // each live handle, including handleAt's, resolves to its own value.
+    Xoshiro256StarStar rng(14);
+    std::vector<SlotHandle> live;
+    std::map<uint64_t, int> expected;   // keyed by index << 32 | generation
+    for (int i = 0; i < 20000; ++i) {
+        if (live.empty() || uniformBelow(rng, 3) != 0) {
+            const SlotHandle h = map.insert(i);
+            live.push_back(h);
+            expected[uint64_t(h.index) << 32 | h.generation] = i;
+        } else {
+            const size_t k = static_cast<size_t>(uniformBelow(rng, live.size()));
+            CHECK(map.remove(live[k]) && !map.contains(live[k]));
+            expected.erase(uint64_t(live[k].index) << 32 | live[k].generation);
+            live[k] = live.back();
+            live.pop_back();
+        }
+    }
+    CHECK(map.size() == live.size() && map.values().size() == live.size());
+    for (size_t i = 0; i < live.size(); ++i) {
+        CHECK(*map.get(live[i]) == expected[uint64_t(live[i].index) << 32 | live[i].generation]);
+    }
+    for (size_t i = 0; i < map.size(); ++i) CHECK(map.get(map.handleAt(i)) == &map.values()[i]);
+
+    // Inventory handles survive other stacks being sold out.
+    HeadlessGame game;
+    Player& player = game.getPlayer();
+    player.addItem(0);
+    player.addItem(1);
+    player.addItem(2);
+    const SlotHandle first = player.getInventory().findStack(0);
+    const SlotHandle last = player.getInventory().findStack(2);
+    CHECK(player.sellItem(first) == 1 && player.sellItem(first) == 0);
+    CHECK(player.getInventory().getStack(last)->item == 2 && player.sellItem(last) == 1);
+
+    return checkResult("SlotMapTest");
+}
@@ -0,0 +1,50 @@
+// StratifiedSimulation: replicates do not depend on the thread count, session
+// counts round up to a power of two, and every source's cost and hit rate
+// match the exact PityChain values within five standard errors.
+#include "PityChain.h"
+#include "StratifiedSimulation.h"
+#include "Check.h"
+
+int main() {
+    const HeadlessGame game;
+    const GachaPool& pool = game.getPool();
+    const size_t pity = game.getPityRateState();
+    const StratifiedSimulation stratified(pool, pity);
+    const UniformSource sources[] = { UniformSource::Pseudo, UniformSource::LatinHypercube, UniformSource::Halton };
+    const size_t SourceCount = sizeof(sources) / sizeof(sources[0]);
+
+    // 100 sessions round up to 128, so chunks straddle replicates.
+    StratifiedConfig config;
+    config.sessions = 100;
+    config.replicates = 8;
+    const unsigned threadCounts[] = { 2, 3, 8 };
+    for (size_t i = 0; i < SourceCount; ++i) {
+        config.threads = 1;
+        const StratifiedResult single = stratified.run(config, sources[i]);
+        CHECK(single.config.sessions == 128 && single.replicateCost.size() == config.replicates);
+        for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); ++t) {
+            config.threads = threadCounts[t];
+            const StratifiedResult result = stratified.run(config, sources[i]);
+            CHECK(result.replicateCost == single.replicateCost && result.replicateHit == single.replicateHit);
+        }
+    }
+
+    // E[min(T, cap)] is the sum of the survival function of the first-hit
+    // time T.
+    StratifiedConfig exact;
+    exact.threads = 1;
+    const std::vector<double> firstHit =
+        PityChain(pool, pity).pullsToDistribution(exact.targetRarity, exact.pullCap, true);
+    double survival = 1.0, expectedPulls = 0.0;
+    for (uint32_t k = 1; k <= exact.pullCap; ++k) {
+        expectedPulls += survival;
+        survival -= firstHit[k];
+    }
+    for (size_t i = 0; i < SourceCount; ++i) {
+        const StratifiedResult result = stratified.run(exact, sources[i]);
+        CHECK_NEAR(result.meanCost(), expectedPulls * exact.pullCost, result.costStandardError(), 5.0);
+        CHECK_NEAR(result.hitProbability(), 1.0 - survival, result.hitStandardError(), 5.0);
+    }
+
+    return checkResult("StratifiedTest");
+}
@@ -0,0 +1,59 @@
+// Two-level sampling: tier weights are the items' rates plus the rate state's
+// bonus, linear draws match the exact probabilities, tier edits leave the items
+// alone, and tierAt splits [0, 1) at the cumulative tier weights.
+#include "SamplingCheck.h"
+
+static void checkTierAt(const GachaPool& pool, size_t state) {
+    const double total = double(pool.getStateTotalWeight(state));
+    double boundary = 0.0;
+    size_t previous = 0;
+    for (int i = 0; i < 100000; ++i) {
+        const size_t t = pool.tierAt(i / 100000.0, state);
+        CHECK(t >= previous && t < pool.getTierCount());
+        previous = t;
+    }
+    for (size_t t = 0; t + 1 < pool.getTierCount(); ++t) {
+        boundary += pool.getTierWeight(t, state) / total;
+        CHECK(pool.tierAt(boundary * (1.0 - 1e-9), state) == t);
+        CHECK(pool.tierAt(boundary * (1.0 + 1e-9), state) == t + 1);
+    }
+}
+
+int main() {
+    DefaultBannerPool banner;
+    GachaPool& pool = banner.pool;
+    const size_t pity = banner.pity;
+
+    CHECK(pool.getTierCount() == DefaultBanner.tierCount);
+    for (size_t t = 0; t < pool.getTierCount(); ++t) {
+        const BannerTier& tier = DefaultBanner.tiers[t];
+        CHECK(pool.getTierRarity(t) == tier.rarity);
+        const GachaPool::Weight items = pool.getTierWeight(t, 0);
+        CHECK(items > 0);
+        CHECK(pool.getTierWeight(t, pity) == items + tier.pityBonusPerItem * pool.getTierSize(tier.rarity));
+    }
+    checkSampling(pool, SamplingMode::Linear, pity, 300);
+    checkTierAt(pool, 0);
+    checkTierAt(pool, pity);
+
+    // A tier edit changes that tier's odds in the current state only.
+    const GachaPool::Weight before = pool.getTierWeight(1, 0);
+    pool.setRateState(pity);
+    pool.increaseTierRate(2, 30.0);
+    pool.setRateState(0);
+    pool.prepare();
+    CHECK(pool.getTierWeight(1, 0) == before);
+    CHECK(pool.getTierWeight(1, pity) == before + GachaPool::toWeight(30.0));
+    checkSampling(pool, SamplingMode::Linear, pity, 400);
+    checkTierAt(pool, pity);
+
+    // A new rarity gets its own tier, in order.
+    GachaPool small;
+    small.addItem(banner.catalog.intern("Test Relic", 5), 5, 1.0);
+    small.addItem(0, 1, 3.0);
+    small.prepare();
+    CHECK(small.getTierCount() == 2 && small.getTierRarity(0) == 1 && small.getTierRarity(1) == 5);
+    CHECK(small.tierAt(0.74, 0) == 0 && small.tierAt(0.76, 0) == 1);
+
+    return checkResult("TwoLevelTest");
+}